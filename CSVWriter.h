@@ -0,0 +1,185 @@
+#ifndef CSVWRITER_H
+#define CSVWRITER_H
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Formats fields with std::to_chars into one reusable buffer and hands it to
+// an unbuffered FILE in large blocks, so neither iostream formatting nor a
+// second copy through a stringstream sits between the values and the disk.
+class CSVWriter {
+   public:
+    static constexpr std::size_t BlockSize{1 << 20};
+    static constexpr std::size_t MaxField{64};
+
+    CSVWriter(const std::string &fileName) : fp{std::fopen(fileName.c_str(), "wb")}, buf(BlockSize + MaxField) {
+        if (fp == nullptr) {
+            std::cerr << "Open file failed..." << std::endl;
+            exit(-1);
+        }
+        std::setvbuf(fp, nullptr, _IONBF, 0);
+    }
+
+    CSVWriter(const CSVWriter &) = delete;
+    CSVWriter &operator=(const CSVWriter &) = delete;
+
+    ~CSVWriter() {
+        flush();
+        std::fclose(fp);
+    }
+
+    // Appends value followed by a ',' separator.
+    template <class T>
+    CSVWriter &field(T value) {
+        if (len + MaxField > buf.size()) flush();
+        char *p{buf.data() + len};
+        char *end{buf.data() + buf.size()};
+        std::to_chars_result r;
+        if constexpr (std::is_floating_point<T>::value) {
+#if defined(__cpp_lib_to_chars)
+            r = std::to_chars(p, end, value, std::chars_format::general, 6);  // same digits as operator<<
+#else
+            r = {p + std::snprintf(p, end - p, "%g", static_cast<double>(value)), std::errc{}};
+#endif
+        } else {
+            r = std::to_chars(p, end, value);
+        }
+        len = r.ptr - buf.data();
+        return put(',');
+    }
+
+    CSVWriter &text(const char *s) {
+        std::size_t n{std::strlen(s)};
+        if (len + n > buf.size()) flush();
+        if (n > buf.size()) {
+            std::fwrite(s, 1, n, fp);
+            return *this;
+        }
+        std::memcpy(buf.data() + len, s, n);
+        len += n;
+        return *this;
+    }
+
+    // Ends the row, replacing the separator left by the last field().
+    CSVWriter &endRow() {
+        if (len > 0 && buf[len - 1] == ',') len--;
+        if (len + 1 > buf.size()) flush();
+        put('\n');
+        if (len >= BlockSize) flush();
+        return *this;
+    }
+
+    void flush() {
+        if (len > 0) std::fwrite(buf.data(), 1, len, fp);
+        len = 0;
+    }
+
+   private:
+    CSVWriter &put(char c) {
+        buf[len++] = c;
+        return *this;
+    }
+
+    std::FILE *fp;
+    std::vector<char> buf;
+    std::size_t len{0};
+};
+
+// Binary columnar table that can be mmapped directly:
+//   char     magic[8]     "CVCOL01\0"
+//   uint64   rows, columns
+//   columns x { char name[32]; uint8 kind ('i', 'u' or 'f'); uint8 width; uint8 pad[6]; }
+//   column 0 values, column 1 values, ...   (rows * width bytes each)
+// Every integer and value is little-endian; each column starts 8-byte aligned.
+namespace Columnar {
+    inline void putLE(std::vector<char> &out, std::uint64_t v, int width) {
+        for (int b = 0; b < width; b++) out.push_back(static_cast<char>((v >> (8 * b)) & 0xFF));
+    }
+
+    template <class T>
+    std::uint64_t bits(T v) {
+        std::uint64_t u = 0;
+        std::memcpy(&u, &v, sizeof(T));  // the bit pattern; byte order fixed by putLE
+        return u;
+    }
+}  // namespace Columnar
+
+template <class T>
+void writeColumns(const std::vector<std::vector<T>> &rows, const std::vector<std::string> &names, const std::string &fileName) {
+    using namespace Columnar;
+    static_assert(std::is_arithmetic<T>::value && sizeof(T) <= 8, "columns hold plain numbers");
+    std::uint64_t m{rows.size()}, cols{names.size()};
+
+    std::vector<char> out;
+    out.reserve(24 + cols * 40 + cols * ((m * sizeof(T) + 7) / 8 * 8));
+    out.insert(out.end(), {'C', 'V', 'C', 'O', 'L', '0', '1', '\0'});
+    putLE(out, m, 8);
+    putLE(out, cols, 8);
+    for (auto &name : names) {
+        char field[32]{};
+        std::strncpy(field, name.c_str(), sizeof(field) - 1);
+        out.insert(out.end(), field, field + sizeof(field));
+        out.push_back(std::is_floating_point<T>::value ? 'f' : (std::is_signed<T>::value ? 'i' : 'u'));
+        out.push_back(static_cast<char>(sizeof(T)));
+        out.insert(out.end(), 6, '\0');
+    }
+
+    for (std::uint64_t c = 0; c < cols; c++) {
+        for (auto &row : rows) {
+            putLE(out, bits(c < row.size() ? row[c] : T{}), sizeof(T));
+        }
+        while (out.size() % 8) out.push_back('\0');
+    }
+
+    std::FILE *fp{std::fopen(fileName.c_str(), "wb")};
+    if (fp == nullptr) {
+        std::cerr << "Open file failed..." << std::endl;
+        exit(-1);
+    }
+    std::setvbuf(fp, nullptr, _IONBF, 0);
+    std::fwrite(out.data(), 1, out.size(), fp);
+    std::fclose(fp);
+}
+
+// vector-of-rows table; every value is followed by ','
+template <class T>
+void writeCSV(const std::vector<std::vector<T>> &v, const std::string &fileName) {
+    CSVWriter os{fileName};
+
+    for (auto &row : v) {
+        for (auto &val : row) {
+            os.field(val);
+        }
+        os.text("\n");
+    }
+}
+
+// histogram as "m,h(m)" rows
+template <class Count, std::size_t N>
+void writeCSV(const std::array<Count, N> &hist, const std::string &fileName) {
+    CSVWriter os{fileName};
+
+    os.text("m,h(m)\n");
+    for (std::size_t i = 0; i < N; i++) {
+        os.field(i).field(hist[i]).endRow();
+    }
+}
+
+template <class Count, std::size_t N>
+void writeColumns(const std::array<Count, N> &hist, const std::string &fileName) {
+    std::vector<std::vector<std::uint64_t>> rows(N);
+    for (std::size_t i = 0; i < N; i++) {
+        rows[i] = {static_cast<std::uint64_t>(i), static_cast<std::uint64_t>(hist[i])};
+    }
+    writeColumns(rows, {"m", "h(m)"}, fileName);
+}
+
+#endif
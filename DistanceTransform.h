@@ -0,0 +1,180 @@
+#ifndef DISTANCETRANSFORM_H
+#define DISTANCETRANSFORM_H
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <opencv2/core.hpp>
+#include <vector>
+
+// Exact Euclidean distance transform (Meijster, Roerdink & Hesselink). Pass 1
+// finds, per column, the vertical distance g to the nearest feature pixel with
+// a downward and an upward sweep over whole rows. Pass 2 takes, per row, the
+// lower envelope of the parabolas (x - u)^2 + g(u)^2. Both passes are linear
+// in the pixel count, all arithmetic is integer, and each pass runs in
+// parallel (pass 1 over column strips, pass 2 over rows).
+namespace DistanceTransform {
+    // squared distance of a pixel whose image has no feature pixel at all
+    constexpr int Infinite{INT_MAX};
+
+    inline std::int64_t floorDiv(std::int64_t a, std::int64_t b) {
+        return a / b - ((a % b != 0) && ((a < 0) != (b < 0)));
+    }
+
+    // one row of pass 2: dt[x] = min over u of (x - u)^2 + g[u]^2
+    inline void envelope(const int *g, int n, int *dt, std::int64_t inf2, std::vector<int> &s, std::vector<int> &t) {
+        auto f{[&](int x, int i) { return std::int64_t{x - i} * (x - i) + std::int64_t{g[i]} * g[i]; }};
+        auto sep{[&](int i, int u) {
+            return floorDiv(std::int64_t{u} * u - std::int64_t{i} * i + std::int64_t{g[u]} * g[u] - std::int64_t{g[i]} * g[i], 2 * (u - i));
+        }};
+
+        int q = 0;
+        s[0] = t[0] = 0;
+        for (int u = 1; u < n; u++) {
+            while (q >= 0 && f(t[q], s[q]) > f(t[q], u)) q--;
+            if (q < 0) {
+                q = 0;
+                s[0] = u;
+            } else {
+                std::int64_t w{1 + sep(s[q], u)};
+                if (w < n) {
+                    q++;
+                    s[q] = u;
+                    t[q] = static_cast<int>(w);
+                }
+            }
+        }
+        for (int u = n - 1; u >= 0; u--) {
+            std::int64_t d{f(u, s[q])};
+            dt[u] = d >= inf2 ? Infinite : static_cast<int>(d);
+            if (u == t[q]) q--;
+        }
+    }
+
+    // Squared distance (CV_32SC1) from every pixel to the nearest pixel where
+    // feature(value) holds; Infinite when there is none.
+    template <class Feature>
+    cv::Mat squared(const cv::Mat &image, Feature feature) {
+        int m = image.rows, n = image.cols;
+        CV_Assert(std::int64_t{m} * m + std::int64_t{n} * n < INT_MAX);
+        cv::Mat g(m, n, CV_32SC1), image_(m, n, CV_32SC1);
+        if (m == 0 || n == 0) return image_;
+
+        // larger than any real distance in the image, small enough not to overflow
+        const int inf{m + n};
+        const std::int64_t inf2{std::int64_t{inf} * inf};
+
+        int strips{std::max(1, std::min(cv::getNumThreads(), n / 64))};
+        cv::parallel_for_(cv::Range(0, strips), [&](const cv::Range &range) {
+            for (int s = range.start; s < range.end; s++) {
+                int c0{static_cast<int>(std::int64_t{n} * s / strips)}, c1{static_cast<int>(std::int64_t{n} * (s + 1) / strips)};
+                for (int i = 0; i < m; i++) {
+                    const uchar *src{image.ptr<uchar>(i)};
+                    int *gi{g.ptr<int>(i)};
+                    const int *gp{i > 0 ? g.ptr<int>(i - 1) : nullptr};
+                    for (int j = c0; j < c1; j++) {
+                        gi[j] = feature(src[j]) ? 0 : (gp ? std::min(gp[j] + 1, inf) : inf);
+                    }
+                }
+                for (int i = m - 2; i >= 0; i--) {
+                    int *gi{g.ptr<int>(i)};
+                    const int *gn{g.ptr<int>(i + 1)};
+                    for (int j = c0; j < c1; j++) {
+                        gi[j] = std::min(gi[j], gn[j] + 1);
+                    }
+                }
+            }
+        });
+
+        cv::parallel_for_(cv::Range(0, m), [&](const cv::Range &range) {
+            std::vector<int> s(n), t(n);
+            for (int i = range.start; i < range.end; i++) {
+                envelope(g.ptr<int>(i), n, image_.ptr<int>(i), inf2, s, t);
+            }
+        });
+
+        return image_;
+    }
+}  // namespace DistanceTransform
+
+// squared distance from each pixel to the nearest background (zero) pixel
+inline cv::Mat squaredDistanceToBackground(const cv::Mat &image) {
+    return DistanceTransform::squared(image, [](uchar v) { return v == 0; });
+}
+
+// squared distance from each pixel to the nearest foreground (non-zero) pixel
+inline cv::Mat squaredDistanceToForeground(const cv::Mat &image) {
+    return DistanceTransform::squared(image, [](uchar v) { return v != 0; });
+}
+
+// Euclidean distance map (CV_32FC1) of the foreground: 0 on background,
+// +inf when the image has no background pixel.
+inline cv::Mat distanceMap(const cv::Mat &image) {
+    cv::Mat d2{squaredDistanceToBackground(image)};
+    cv::Mat image_(image.rows, image.cols, CV_32FC1);
+
+    for (int i = 0; i < image.rows; i++) {
+        const int *src{d2.ptr<int>(i)};
+        float *dst{image_.ptr<float>(i)};
+        for (int j = 0; j < image.cols; j++) {
+            dst[j] = src[j] == DistanceTransform::Infinite ? INFINITY : std::sqrt(static_cast<float>(src[j]));
+        }
+    }
+
+    return image_;
+}
+
+// Offsets {dy, dx} with dy^2 + dx^2 <= radius^2.
+inline std::vector<std::vector<int>> diskKernel(int radius) {
+    CV_Assert(radius >= 0);
+    std::vector<std::vector<int>> kernel;
+    for (int i = -radius; i <= radius; i++) {
+        for (int j = -radius; j <= radius; j++) {
+            if (i * i + j * j <= radius * radius)
+                kernel.push_back({i, j});
+        }
+    }
+    return kernel;
+}
+
+// Binary erosion by diskKernel(radius), offsets outside the image ignored: a
+// pixel survives when no background pixel lies within the disk around it.
+// Infinite is tested first since radius^2 may exceed it.
+inline cv::Mat diskErosion(const cv::Mat &image, int radius) {
+    CV_Assert(radius >= 0);
+    cv::Mat d2{squaredDistanceToBackground(image)};
+    cv::Mat image_(image.rows, image.cols, CV_8UC1);
+    std::int64_t r2{std::int64_t{radius} * radius};
+
+    for (int i = 0; i < image.rows; i++) {
+        const int *src{d2.ptr<int>(i)};
+        uchar *dst{image_.ptr<uchar>(i)};
+        for (int j = 0; j < image.cols; j++) {
+            dst[j] = src[j] == DistanceTransform::Infinite || src[j] > r2 ? 0xFF : 0;
+        }
+    }
+
+    return image_;
+}
+
+// Binary dilation by diskKernel(radius): a pixel is set when a foreground
+// pixel lies within the disk around it.
+inline cv::Mat diskDilation(const cv::Mat &image, int radius) {
+    CV_Assert(radius >= 0);
+    cv::Mat d2{squaredDistanceToForeground(image)};
+    cv::Mat image_(image.rows, image.cols, CV_8UC1);
+    std::int64_t r2{std::int64_t{radius} * radius};
+
+    for (int i = 0; i < image.rows; i++) {
+        const int *src{d2.ptr<int>(i)};
+        uchar *dst{image_.ptr<uchar>(i)};
+        for (int j = 0; j < image.cols; j++) {
+            dst[j] = src[j] != DistanceTransform::Infinite && src[j] <= r2 ? 0xFF : 0;
+        }
+    }
+
+    return image_;
+}
+
+#endif
@@ -0,0 +1,170 @@
+#ifndef FLIP_H
+#define FLIP_H
+
+#include <algorithm>
+#include <cstring>
+#include <opencv2/core.hpp>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Cache-blocked flip / transpose kernels for single-channel 8-bit images.
+// Transposes walk the image in Block x Block macro tiles so every cache line
+// of the destination is completed while it is still resident, and each macro
+// tile is split into Tile x Tile micro tiles that are transposed in registers.
+namespace Flip {
+    constexpr int Tile{16};
+    constexpr int Block{64};
+
+#if defined(__SSE2__)
+    // Reverse the 16 bytes of a register using only SSE2 shuffles.
+    inline __m128i reverse16(__m128i v) {
+        v = _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+        v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    }
+
+    // Four rounds of interleaving row k with row k + 8 transpose a 16x16 byte tile.
+    inline void transposeTile(const uchar *src, size_t srcStep, uchar *dst, size_t dstStep) {
+        __m128i a[Tile], b[Tile];
+        for (int k = 0; k < Tile; k++)
+            a[k] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + k * srcStep));
+
+        for (int round = 0; round < 4; round++) {
+            for (int k = 0; k < Tile / 2; k++) {
+                b[2 * k] = _mm_unpacklo_epi8(a[k], a[k + Tile / 2]);
+                b[2 * k + 1] = _mm_unpackhi_epi8(a[k], a[k + Tile / 2]);
+            }
+            std::copy(b, b + Tile, a);
+        }
+
+        for (int k = 0; k < Tile; k++)
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + k * dstStep), a[k]);
+    }
+#else
+    inline void transposeTile(const uchar *src, size_t srcStep, uchar *dst, size_t dstStep) {
+        for (int i = 0; i < Tile; i++)
+            for (int j = 0; j < Tile; j++)
+                dst[j * dstStep + i] = src[i * srcStep + j];
+    }
+#endif
+
+    // Scalar transpose of an arbitrary h x w block, used for the ragged edges.
+    inline void transposeBlock(const uchar *src, size_t srcStep, uchar *dst, size_t dstStep, int h, int w) {
+        for (int i = 0; i < h; i++) {
+            const uchar *s{src + i * srcStep};
+            for (int j = 0; j < w; j++) {
+                dst[j * dstStep + i] = s[j];
+            }
+        }
+    }
+
+    // dst(j, i) = src(i, j); dst must already be src.cols x src.rows.
+    inline void transpose(const cv::Mat &src, cv::Mat &dst) {
+        int m = src.rows, n = src.cols;
+        size_t srcStep{src.step}, dstStep{dst.step};
+
+        for (int bi = 0; bi < m; bi += Block) {
+            for (int bj = 0; bj < n; bj += Block) {
+                int ei{std::min(bi + Block, m)}, ej{std::min(bj + Block, n)};
+                for (int i = bi; i < ei; i += Tile) {
+                    for (int j = bj; j < ej; j += Tile) {
+                        const uchar *s{src.ptr<uchar>(i) + j};
+                        uchar *d{dst.ptr<uchar>(j) + i};
+                        if (i + Tile <= ei && j + Tile <= ej)
+                            transposeTile(s, srcStep, d, dstStep);
+                        else
+                            transposeBlock(s, srcStep, d, dstStep, std::min(Tile, ei - i), std::min(Tile, ej - j));
+                    }
+                }
+            }
+        }
+    }
+
+    // In-place transpose, square images only: swap tile (I, J) with tile (J, I).
+    inline void transposeInPlace(cv::Mat &image) {
+        CV_Assert(image.rows == image.cols);
+        int n = image.rows, full{n - n % Tile};
+        size_t step{image.step};
+        uchar a[Tile * Tile], b[Tile * Tile];
+
+        for (int i = 0; i < full; i += Tile) {
+            for (int j = i; j < full; j += Tile) {
+                uchar *p{image.ptr<uchar>(i) + j}, *q{image.ptr<uchar>(j) + i};
+                transposeTile(p, step, a, Tile);
+                if (i != j)
+                    transposeTile(q, step, b, Tile);
+                for (int k = 0; k < Tile; k++) {
+                    std::memcpy(q + k * step, a + k * Tile, Tile);
+                    if (i != j)
+                        std::memcpy(p + k * step, b + k * Tile, Tile);
+                }
+            }
+        }
+
+        // ragged right/bottom strip
+        for (int i = 0; i < n; i++) {
+            uchar *row{image.ptr<uchar>(i)};
+            for (int j = std::max(i + 1, full); j < n; j++) {
+                std::swap(row[j], image.ptr<uchar>(j)[i]);
+            }
+        }
+    }
+
+    inline void reverseRow(const uchar *src, uchar *dst, int n) {
+        int j = 0;
+#if defined(__SSE2__)
+        for (; j + 16 <= n; j += 16) {
+            __m128i v{_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + n - j - 16))};
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + j), reverse16(v));
+        }
+#endif
+        for (; j < n; j++) {
+            dst[j] = src[n - j - 1];
+        }
+    }
+
+    inline void reverseRowInPlace(uchar *row, int n) {
+        int l = 0, r = n;
+#if defined(__SSE2__)
+        for (; l + 32 <= r; l += 16, r -= 16) {
+            __m128i a{_mm_loadu_si128(reinterpret_cast<const __m128i *>(row + l))};
+            __m128i b{_mm_loadu_si128(reinterpret_cast<const __m128i *>(row + r - 16))};
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(row + l), reverse16(b));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(row + r - 16), reverse16(a));
+        }
+#endif
+        std::reverse(row + l, row + r);
+    }
+
+    // Row order reversal is a whole-row copy per row.
+    inline void flipRows(const cv::Mat &src, cv::Mat &dst) {
+        int m = src.rows, n = src.cols;
+        for (int i = 0; i < m; i++) {
+            std::memcpy(dst.ptr<uchar>(m - i - 1), src.ptr<uchar>(i), n);
+        }
+    }
+
+    inline void flipRowsInPlace(cv::Mat &image) {
+        int m = image.rows, n = image.cols;
+        for (int i = 0; i < m / 2; i++) {
+            std::swap_ranges(image.ptr<uchar>(i), image.ptr<uchar>(i) + n, image.ptr<uchar>(m - i - 1));
+        }
+    }
+
+    inline void flipCols(const cv::Mat &src, cv::Mat &dst) {
+        for (int i = 0; i < src.rows; i++) {
+            reverseRow(src.ptr<uchar>(i), dst.ptr<uchar>(i), src.cols);
+        }
+    }
+
+    inline void flipColsInPlace(cv::Mat &image) {
+        for (int i = 0; i < image.rows; i++) {
+            reverseRowInPlace(image.ptr<uchar>(i), image.cols);
+        }
+    }
+}  // namespace Flip
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <opencv2/core.hpp>
+#include <vector>
+
+using GrayscaleArray = std::array<std::uint64_t, 256>;
+
+namespace Histogram {
+    // Sub-histograms per band: consecutive pixels go to different banks, so a
+    // run of equal values does not serialize on one counter's store->load.
+    constexpr int Banks{4};
+    // Rows per band are capped so a band's 32-bit bank counters cannot wrap.
+    constexpr std::uint64_t MaxBandPixels{1u << 30};
+
+    using Bank = std::array<std::uint32_t, 256>;
+
+    inline void countRow(const uchar *p, int n, Bank *bank) {
+        int j = 0;
+        for (; j + 8 <= n; j += 8) {
+            bank[0][p[j]]++;
+            bank[1][p[j + 1]]++;
+            bank[2][p[j + 2]]++;
+            bank[3][p[j + 3]]++;
+            bank[0][p[j + 4]]++;
+            bank[1][p[j + 5]]++;
+            bank[2][p[j + 6]]++;
+            bank[3][p[j + 7]]++;
+        }
+        for (; j < n; j++) {
+            bank[j & (Banks - 1)][p[j]]++;
+        }
+    }
+
+    inline void countRowMasked(const uchar *p, const uchar *mask, int n, Bank *bank) {
+        for (int j = 0; j < n; j++) {
+            // masked-out pixels land in a bank that is never read
+            bank[mask[j] ? (j & (Banks - 1)) : Banks][p[j]]++;
+        }
+    }
+}  // namespace Histogram
+
+// Histogram of the pixels of image inside roi whose mask (same size as image,
+// optional) is non-zero. Row bands are counted in parallel into private
+// 32-bit banks and reduced into 64-bit counts in band order.
+inline GrayscaleArray countFrequency(const cv::Mat &image, const cv::Rect &roi, const cv::Mat &mask = cv::Mat()) {
+    using namespace Histogram;
+    CV_Assert(image.type() == CV_8UC1);
+    CV_Assert((roi & cv::Rect(0, 0, image.cols, image.rows)) == roi);
+    CV_Assert(mask.empty() || (mask.type() == CV_8UC1 && mask.size() == image.size()));
+    int m = roi.height, n = roi.width;
+    GrayscaleArray freq;
+    freq.fill(0);
+    if (m <= 0 || n <= 0) return freq;
+
+    int bands{std::max(cv::getNumThreads(), 1)};
+    bands = std::max<int>(bands, static_cast<int>(static_cast<std::uint64_t>(m) * n / MaxBandPixels + 1));
+    bands = std::min(bands, m);
+
+    std::vector<Bank> banks(static_cast<std::size_t>(bands) * (Banks + 1));
+
+    cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range &range) {
+        for (int b = range.start; b < range.end; b++) {
+            Bank *bank{&banks[static_cast<std::size_t>(b) * (Banks + 1)]};
+            for (int k = 0; k <= Banks; k++) bank[k].fill(0);
+
+            int r0{static_cast<int>(static_cast<long long>(m) * b / bands)};
+            int r1{static_cast<int>(static_cast<long long>(m) * (b + 1) / bands)};
+            for (int i = r0; i < r1; i++) {
+                const uchar *p{image.ptr<uchar>(roi.y + i) + roi.x};
+                if (mask.empty())
+                    countRow(p, n, bank);
+                else
+                    countRowMasked(p, mask.ptr<uchar>(roi.y + i) + roi.x, n, bank);
+            }
+        }
+    });
+
+    for (int b = 0; b < bands; b++) {
+        const Bank *bank{&banks[static_cast<std::size_t>(b) * (Banks + 1)]};
+        for (int k = 0; k < Banks; k++) {
+            for (int v = 0; v < 256; v++) {
+                freq[v] += bank[k][v];
+            }
+        }
+    }
+
+    return freq;
+}
+
+inline GrayscaleArray countFrequency(const cv::Mat &image) {
+    return countFrequency(image, cv::Rect(0, 0, image.cols, image.rows));
+}
+
+#endif
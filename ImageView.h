@@ -0,0 +1,96 @@
+#ifndef IMAGEVIEW_H
+#define IMAGEVIEW_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <opencv2/core.hpp>
+
+#include "Flip.h"
+
+// Read-only view over a CV_8UC1 image that expresses flips, transposes and
+// 90 degree rotations as a pointer + (row, column) stride remap:
+//     view(i, j) = origin[i * rowStride + j * colStride]
+// Nothing is copied until materialize() is called.
+class ImageView {
+   public:
+    ImageView(const cv::Mat &image)
+        : base{image},
+          origin{image.ptr<uchar>(0)},
+          rowStride{static_cast<std::ptrdiff_t>(image.step)},
+          colStride{1},
+          m{image.rows},
+          n{image.cols} {}
+
+    int rows() const { return m; }
+    int cols() const { return n; }
+    std::ptrdiff_t rowStep() const { return rowStride; }
+    std::ptrdiff_t colStep() const { return colStride; }
+
+    const uchar &operator()(int i, int j) const {
+        return origin[i * rowStride + j * colStride];
+    }
+
+    // Start of view row i; contiguous only when isRowContiguous().
+    const uchar *row(int i) const { return origin + i * rowStride; }
+    bool isRowContiguous() const { return colStride == 1; }
+
+    ImageView flipUpDown() const {
+        ImageView v{*this};
+        v.origin += (m - 1) * rowStride;
+        v.rowStride = -rowStride;
+        return v;
+    }
+
+    ImageView flipLeftRight() const {
+        ImageView v{*this};
+        v.origin += (n - 1) * colStride;
+        v.colStride = -colStride;
+        return v;
+    }
+
+    ImageView transpose() const {
+        ImageView v{*this};
+        std::swap(v.rowStride, v.colStride);
+        std::swap(v.m, v.n);
+        return v;
+    }
+
+    ImageView rotate90() const { return transpose().flipLeftRight(); }  // clockwise
+    ImageView rotate180() const { return flipUpDown().flipLeftRight(); }
+    ImageView rotate270() const { return transpose().flipUpDown(); }
+
+    // Dense copy of the view. An untouched view shares the source buffer; the
+    // shape test keeps the transpose of a one-column image (whose strides
+    // are both 1) from passing for it.
+    cv::Mat materialize() const {
+        if (m == base.rows && n == base.cols && colStride == 1 &&
+            rowStride == static_cast<std::ptrdiff_t>(base.step) && origin == base.ptr<uchar>(0))
+            return base;
+
+        cv::Mat image_(m, n, CV_8UC1);
+        if (std::abs(colStride) == 1) {
+            for (int i = 0; i < m; i++) {
+                if (colStride == 1)
+                    std::memcpy(image_.ptr<uchar>(i), row(i), n);
+                else
+                    Flip::reverseRow(row(i) - (n - 1), image_.ptr<uchar>(i), n);
+            }
+        } else {
+            // transposed orientations: transpose once, then undo the stride signs
+            Flip::transpose(base, image_);
+            if (rowStride < 0) Flip::flipRowsInPlace(image_);
+            if (colStride < 0) Flip::flipColsInPlace(image_);
+        }
+
+        return image_;
+    }
+
+   private:
+    cv::Mat base;  // keeps the pixels alive
+    const uchar *origin;
+    std::ptrdiff_t rowStride, colStride;
+    int m, n;
+};
+
+#endif
@@ -0,0 +1,815 @@
+#ifndef MORPHOLOGY_H
+#define MORPHOLOGY_H
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <opencv2/core.hpp>
+#include <vector>
+
+#include "StructuringElement.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Flat grayscale morphology built from line structuring elements. A line of
+// any length runs with the van Herk/Gil-Werman algorithm: the (padded) line is
+// cut into blocks of the window length, and each output is one max/min of a
+// suffix of one block and a prefix of the next, about 3 comparisons per pixel.
+// Rectangles are a horizontal line followed by a vertical one, and any other
+// kernel is decomposed into the union of rectangles below.
+//
+// A kernel is a list of {dy, dx} offsets; output (i, j) is the max (dilate) or
+// min (erode) of image(i + dy, j + dx) over offsets that fall inside the image.
+namespace Morphology {
+    using Kernel = std::vector<std::vector<int>>;
+
+    // offsets dy in [top, bottom] x dx in [left, right]
+    struct Box {
+        int top, bottom, left, right;
+    };
+
+    struct Max {
+        static constexpr uchar identity{0};
+        uchar operator()(uchar a, uchar b) const { return std::max(a, b); }
+#if defined(__AVX2__)
+        __m256i operator()(__m256i a, __m256i b) const { return _mm256_max_epu8(a, b); }
+#elif defined(__SSE2__)
+        __m128i operator()(__m128i a, __m128i b) const { return _mm_max_epu8(a, b); }
+#endif
+    };
+
+    struct Min {
+        static constexpr uchar identity{UCHAR_MAX};
+        uchar operator()(uchar a, uchar b) const { return std::min(a, b); }
+#if defined(__AVX2__)
+        __m256i operator()(__m256i a, __m256i b) const { return _mm256_min_epu8(a, b); }
+#elif defined(__SSE2__)
+        __m128i operator()(__m128i a, __m128i b) const { return _mm_min_epu8(a, b); }
+#endif
+    };
+
+    // dst[j] = op(a[j], b[j]) for j < n; dst may be a
+    template <class Op>
+    void combine(uchar *dst, const uchar *a, const uchar *b, int n, Op op) {
+        int j = 0;
+#if defined(__AVX2__)
+        for (; j + 32 <= n; j += 32) {
+            __m256i va{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + j))};
+            __m256i vb{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + j))};
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + j), op(va, vb));
+        }
+#elif defined(__SSE2__)
+        for (; j + 16 <= n; j += 16) {
+            __m128i va{_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + j))};
+            __m128i vb{_mm_loadu_si128(reinterpret_cast<const __m128i *>(b + j))};
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + j), op(va, vb));
+        }
+#endif
+        for (; j < n; j++) {
+            dst[j] = op(a[j], b[j]);
+        }
+    }
+
+    // Every row of the kernel is split into horizontal runs, and each run is
+    // grown vertically over the neighbouring rows that contain it. The boxes
+    // lie inside the kernel and cover it, so the kernel's max/min is the
+    // max/min of the box results. octagonKernel() becomes a 3x5 and a 5x3 box.
+    inline std::vector<Box> decompose(const Kernel &k) {
+        std::vector<Box> boxes;
+        if (k.empty()) return boxes;
+
+        int top{k[0][0]}, bottom{k[0][0]}, left{k[0][1]}, right{k[0][1]};
+        for (auto &p : k) {
+            top = std::min(top, p[0]), bottom = std::max(bottom, p[0]);
+            left = std::min(left, p[1]), right = std::max(right, p[1]);
+        }
+
+        int h{bottom - top + 1}, w{right - left + 1};
+        std::vector<char> in(static_cast<std::size_t>(h) * w, 0);
+        for (auto &p : k) in[static_cast<std::size_t>(p[0] - top) * w + p[1] - left] = 1;
+        auto has{[&](int y, int a, int b) {
+            for (int x = a; x <= b; x++)
+                if (!in[static_cast<std::size_t>(y) * w + x]) return false;
+            return true;
+        }};
+
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                if (!in[static_cast<std::size_t>(y) * w + x]) continue;
+                int a{x};
+                while (x + 1 < w && in[static_cast<std::size_t>(y) * w + x + 1]) x++;
+
+                int y0{y}, y1{y};
+                while (y0 > 0 && has(y0 - 1, a, x)) y0--;
+                while (y1 + 1 < h && has(y1 + 1, a, x)) y1++;
+
+                Box b{y0 + top, y1 + top, a + left, x + left};
+                bool seen = false;
+                for (auto &o : boxes)
+                    seen |= o.top == b.top && o.bottom == b.bottom && o.left == b.left && o.right == b.right;
+                if (!seen) boxes.push_back(b);
+            }
+        }
+        return boxes;
+    }
+
+    // dst[x] = op over src[x + lo .. x + hi] (stride apart), identity outside [0, n).
+    // g and h hold at least n + 2 * (hi - lo) elements.
+    template <class Op>
+    void line(const uchar *src, int stride, int n, int lo, int hi, uchar *dst, int dstStride, uchar *g, uchar *h, Op op) {
+        const uchar id{Op::identity};
+        int L{hi - lo + 1};
+        if (L == 1) {
+            for (int x = 0; x < n; x++) {
+                int t{x + lo};
+                dst[x * dstStride] = (t >= 0 && t < n) ? src[t * stride] : id;
+            }
+            return;
+        }
+
+        int N{(n + L - 1 + L - 1) / L * L};
+        for (int t = 0; t < N; t++) {
+            int s{t + lo};
+            uchar a{(s >= 0 && s < n) ? src[s * stride] : id};
+            g[t] = (t % L == 0) ? a : op(g[t - 1], a);
+            h[t] = a;
+        }
+        for (int t = N - 2; t >= 0; t--) {
+            if (t % L != L - 1) h[t] = op(h[t + 1], h[t]);
+        }
+        for (int x = 0; x < n; x++) {
+            dst[x * dstStride] = op(h[x], g[x + L - 1]);
+        }
+    }
+
+    // line() for dilation and erosion at once: one scan of src fills both
+    // prefix/suffix pairs. g and h hold at least 2 * (n + 2 * (hi - lo)) elements.
+    inline void line(const uchar *src, int n, int lo, int hi, uchar *dmax, uchar *dmin, uchar *g, uchar *h) {
+        int L{hi - lo + 1};
+        int N{(n + L - 1 + L - 1) / L * L};
+        uchar *gx{g}, *gn{g + N}, *hx{h}, *hn{h + N};
+        for (int t = 0; t < N; t++) {
+            int s{t + lo};
+            bool in{s >= 0 && s < n};
+            uchar ax{in ? src[s] : Max::identity}, an{in ? src[s] : Min::identity};
+            gx[t] = (t % L == 0) ? ax : std::max(gx[t - 1], ax);
+            gn[t] = (t % L == 0) ? an : std::min(gn[t - 1], an);
+            hx[t] = ax, hn[t] = an;
+        }
+        for (int t = N - 2; t >= 0; t--) {
+            if (t % L != L - 1) hx[t] = std::max(hx[t + 1], hx[t]), hn[t] = std::min(hn[t + 1], hn[t]);
+        }
+        for (int x = 0; x < n; x++) {
+            dmax[x] = std::max(hx[x], gx[x + L - 1]);
+            dmin[x] = std::min(hn[x], gn[x + L - 1]);
+        }
+    }
+
+    // Horizontal pass per row, then a vertical pass that runs the same
+    // recurrence on whole rows so the inner loops stay contiguous.
+    template <class Op>
+    cv::Mat box(const cv::Mat &image, const Box &b, Op op) {
+        int m = image.rows, n = image.cols;
+        cv::Mat tmp(m, n, CV_8UC1), image_(m, n, CV_8UC1);
+
+        int L{b.right - b.left + 1};
+        std::vector<uchar> g(n + 2 * L), h(n + 2 * L);
+        for (int i = 0; i < m; i++) {
+            line(image.ptr<uchar>(i), 1, n, b.left, b.right, tmp.ptr<uchar>(i), 1, g.data(), h.data(), op);
+        }
+
+        int lo{b.top}, V{b.bottom - b.top + 1};
+        int N{(m + V - 1 + V - 1) / V * V};
+        std::vector<uchar> G(static_cast<std::size_t>(N) * n), H(static_cast<std::size_t>(N) * n);
+        const uchar id{Op::identity};
+        std::vector<uchar> blank(n, id);
+        auto src{[&](int t) {
+            int s{t + lo};
+            return (s >= 0 && s < m) ? tmp.ptr<uchar>(s) : blank.data();
+        }};
+
+        for (int t = 0; t < N; t++) {
+            const uchar *a{src(t)};
+            uchar *gt{&G[static_cast<std::size_t>(t) * n]};
+            if (t % V == 0) {
+                std::copy(a, a + n, gt);
+            } else {
+                const uchar *gp{gt - n};
+                for (int j = 0; j < n; j++) gt[j] = op(gp[j], a[j]);
+            }
+        }
+        for (int t = N - 1; t >= 0; t--) {
+            const uchar *a{src(t)};
+            uchar *ht{&H[static_cast<std::size_t>(t) * n]};
+            if (t % V == V - 1) {
+                std::copy(a, a + n, ht);
+            } else {
+                const uchar *hn{ht + n};
+                for (int j = 0; j < n; j++) ht[j] = op(hn[j], a[j]);
+            }
+        }
+        for (int i = 0; i < m; i++) {
+            const uchar *hi{&H[static_cast<std::size_t>(i) * n]}, *gi{&G[static_cast<std::size_t>(i + V - 1) * n]};
+            uchar *dst{image_.ptr<uchar>(i)};
+            for (int j = 0; j < n; j++) dst[j] = op(hi[j], gi[j]);
+        }
+
+        return image_;
+    }
+
+    template <class Op>
+    cv::Mat apply(const cv::Mat &image, const Kernel &k, Op op) {
+        int m = image.rows, n = image.cols;
+        const uchar id{Op::identity};
+        cv::Mat image_(m, n, CV_8UC1, cv::Scalar::all(id));
+
+        for (auto &b : decompose(k)) {
+            cv::Mat part{box(image, b, op)};
+            for (int i = 0; i < m; i++) {
+                const uchar *src{part.ptr<uchar>(i)};
+                uchar *dst{image_.ptr<uchar>(i)};
+                for (int j = 0; j < n; j++) dst[j] = op(dst[j], src[j]);
+            }
+        }
+
+        return image_;
+    }
+
+    // Small kernels (within 5x5) without decomposition. Taps are grouped by
+    // column offset; each distinct set of row offsets is reduced once per
+    // row into a partial row, whole rows at a time, and every column offset
+    // of the kernel is then one shifted load of a partial row. Interior
+    // pixels need no bounds checks; the border ring tests each tap.
+    template <class Op>
+    class SmallKernel {
+       public:
+        SmallKernel(const Kernel &k, int rows, int cols, Op op) : k{k}, m{rows}, n{cols}, op{op} {
+            if (k.empty()) return;
+            top = bottom = k[0][0], left = right = k[0][1];
+            for (auto &p : k) {
+                top = std::min(top, p[0]), bottom = std::max(bottom, p[0]);
+                left = std::min(left, p[1]), right = std::max(right, p[1]);
+            }
+
+            for (int dx = left; dx <= right; dx++) {
+                std::vector<int> dys;
+                for (int dy = top; dy <= bottom; dy++)
+                    for (auto &p : k)
+                        if (p[0] == dy && p[1] == dx) {
+                            dys.push_back(dy);
+                            break;
+                        }
+                if (dys.empty()) continue;
+                int s = std::find(sets.begin(), sets.end(), dys) - sets.begin();
+                if (s == static_cast<int>(sets.size())) sets.push_back(dys);
+                columns.push_back({dx, s});
+            }
+            partial.assign(sets.size(), std::vector<uchar>(n));
+
+            y0 = std::max(0, -top), y1 = std::min(m, m - bottom);
+            x0 = std::min(n, std::max(0, -left)), x1 = std::max(x0, std::min(n, n - right));
+        }
+
+        int height() const { return bottom - top + 1; }
+
+        // Row i of the result; rows(y) is source row y for y in [i + top, i + bottom] ∩ [0, m).
+        template <class Rows>
+        void row(Rows rows, int i, uchar *dst) {
+            const uchar id{Op::identity};
+            auto border{[&](int j) {
+                uchar v{id};
+                for (auto &p : k) {
+                    int y{i + p[0]}, x{j + p[1]};
+                    if (y >= 0 && x >= 0 && y < m && x < n)
+                        v = op(v, rows(y)[x]);
+                }
+                return v;
+            }};
+
+            if (i < y0 || i >= y1) {
+                for (int j = 0; j < n; j++) dst[j] = border(j);
+                return;
+            }
+
+            for (std::size_t s = 0; s < sets.size(); s++) {
+                uchar *part{partial[s].data()};
+                std::memcpy(part, rows(i + sets[s][0]), n);
+                for (std::size_t r = 1; r < sets[s].size(); r++) combine(part, part, rows(i + sets[s][r]), n, op);
+            }
+
+            int w{x1 - x0};
+            if (w > 0) {
+                std::memcpy(dst + x0, partial[columns[0].second].data() + x0 + columns[0].first, w);
+                for (std::size_t c = 1; c < columns.size(); c++) combine(dst + x0, dst + x0, partial[columns[c].second].data() + x0 + columns[c].first, w, op);
+            }
+
+            for (int j = 0; j < x0; j++) dst[j] = border(j);
+            for (int j = x1; j < n; j++) dst[j] = border(j);
+        }
+
+       private:
+        Kernel k;
+        int m, n;
+        Op op;
+        int top{0}, bottom{0}, left{0}, right{0}, y0{0}, y1{0}, x0{0}, x1{0};
+        // sets[s] are the row offsets of one or more column offsets; columns
+        // pairs each column offset with its set
+        std::vector<std::vector<int>> sets;
+        std::vector<std::pair<int, int>> columns;
+        std::vector<std::vector<uchar>> partial;
+    };
+
+    template <class Op>
+    cv::Mat small(const cv::Mat &image, const Kernel &k, Op op) {
+        int m = image.rows, n = image.cols;
+        cv::Mat image_(m, n, CV_8UC1);
+        SmallKernel<Op> kernel(k, m, n, op);
+        auto rows{[&](int y) { return image.ptr<uchar>(y); }};
+
+        for (int i = 0; i < m; i++) {
+            kernel.row(rows, i, image_.ptr<uchar>(i));
+        }
+
+        return image_;
+    }
+
+    inline bool isSmall(const Kernel &k) {
+        for (auto &p : k)
+            if (p[0] < -2 || p[0] > 2 || p[1] < -2 || p[1] > 2) return false;
+        return !k.empty();
+    }
+
+    inline cv::Mat dilate(const cv::Mat &image, const Kernel &k) {
+        return isSmall(k) ? small(image, k, Max{}) : apply(image, k, Max{});
+    }
+
+    inline cv::Mat erode(const cv::Mat &image, const Kernel &k) {
+        return isSmall(k) ? small(image, k, Min{}) : apply(image, k, Min{});
+    }
+
+    // (2 * ry + 1) x (2 * rx + 1) rectangle centred on the origin
+    inline cv::Mat dilate(const cv::Mat &image, int ry, int rx) {
+        return box(image, Box{-ry, ry, -rx, rx}, Max{});
+    }
+
+    inline cv::Mat erode(const cv::Mat &image, int ry, int rx) {
+        return box(image, Box{-ry, ry, -rx, rx}, Min{});
+    }
+
+    // Compile-time shape: interior pixels, whose taps are all inside the image,
+    // take one unrolled reduction with no bounds checks; only the border ring
+    // tests each tap. Small shapes such as the octagon need no decomposition.
+    // With SSE2/AVX2 the interior runs SmallKernel's scheme on the shape's
+    // compile-time column groups instead: one partial row per distinct set of
+    // row offsets, then one shifted vector pass per column offset.
+    template <class SE, class Op>
+    cv::Mat filter(const cv::Mat &image, Op op) {
+        int m = image.rows, n = image.cols;
+        cv::Mat image_(m, n, CV_8UC1);
+        const uchar id{Op::identity};
+
+        int y0{std::max(0, -SE::top)}, y1{std::min(m, m - SE::bottom)};
+        int x0{std::min(n, std::max(0, -SE::left))}, x1{std::max(x0, std::min(n, n - SE::right))};
+
+        auto border{[&](int i, int j) {
+            uchar v{id};
+            SE::forEach([&](const Offset &o) {
+                int y{i + o.dy}, x{j + o.dx};
+                if (y >= 0 && x >= 0 && y < m && x < n)
+                    v = op(v, image.ptr<uchar>(y)[x]);
+            });
+            return v;
+        }};
+
+#if defined(__SSE2__)
+        constexpr auto columns{SE::columns()};
+        std::vector<uchar> partial(static_cast<std::size_t>(columns.count) * n);
+#else
+        std::ptrdiff_t step{static_cast<std::ptrdiff_t>(image.step)};
+#endif
+
+        for (int i = 0; i < m; i++) {
+            uchar *dst{image_.ptr<uchar>(i)};
+            if (i < y0 || i >= y1) {
+                for (int j = 0; j < n; j++) dst[j] = border(i, j);
+                continue;
+            }
+
+            for (int j = 0; j < x0; j++) dst[j] = border(i, j);
+#if defined(__SSE2__)
+            if (x1 > x0) {
+                for (int s = 0; s < columns.count; s++) {
+                    uchar *part{&partial[static_cast<std::size_t>(s) * n]};
+                    bool first = true;
+                    for (int dy = SE::top; dy <= SE::bottom; dy++) {
+                        if (!(columns.rows[s] >> (dy - SE::top) & 1)) continue;
+                        const uchar *src{image.ptr<uchar>(i + dy)};
+                        if (first) std::memcpy(part, src, n);
+                        else combine(part, part, src, n, op);
+                        first = false;
+                    }
+                }
+
+                bool first = true;
+                for (int c = 0; c < SE::width; c++) {
+                    if (columns.set[c] < 0) continue;
+                    const uchar *src{&partial[static_cast<std::size_t>(columns.set[c]) * n] + x0 + SE::left + c};
+                    if (first) std::memcpy(dst + x0, src, x1 - x0);
+                    else combine(dst + x0, dst + x0, src, x1 - x0, op);
+                    first = false;
+                }
+            }
+#else
+            const uchar *src{image.ptr<uchar>(i)};
+            for (int j = x0; j < x1; j++) dst[j] = SE::reduce(src + j, step, id, op);
+#endif
+            for (int j = x1; j < n; j++) dst[j] = border(i, j);
+        }
+
+        return image_;
+    }
+
+    template <class SE>
+    cv::Mat dilate(const cv::Mat &image) {
+        return filter<SE>(image, Max{});
+    }
+
+    template <class SE>
+    cv::Mat erode(const cv::Mat &image) {
+        return filter<SE>(image, Min{});
+    }
+
+    // Fused pipelines: each stage pulls rows from the one before it and keeps
+    // only a ring of recent rows, so a chain such as erode -> dilate -> dilate
+    // -> erode never materializes an intermediate image and its memory does
+    // not grow with the image height.
+    //
+    // row(i) is requested with nondecreasing newest rows; a consumer calls
+    // keep(depth) before the first request so the depth most recent rows of
+    // its source stay readable.
+    class RowStream {
+       public:
+        RowStream(int rows, int cols) : m{rows}, n{cols} {}
+        virtual ~RowStream() = default;
+        virtual const uchar *row(int i) = 0;
+        virtual void keep(int /*depth*/) {}
+        int rows() const { return m; }
+        int cols() const { return n; }
+
+       protected:
+        int m, n;
+    };
+
+    class MatStream : public RowStream {
+       public:
+        MatStream(const cv::Mat &image) : RowStream(image.rows, image.cols), image{image} {}
+        const uchar *row(int i) override { return image.ptr<uchar>(i); }
+
+       private:
+        cv::Mat image;
+    };
+
+    // box() as a stream: per box, a ring of V horizontally filtered rows, the
+    // van Herk/Gil-Werman suffix rows of the current block and one running
+    // prefix row. Kernels within 5x5 run SmallKernel on the source rows.
+    template <class Op>
+    class FilterStream : public RowStream {
+       public:
+        FilterStream(RowStream &source, const Kernel &k, Op op) : RowStream(source.rows(), source.cols()), src{source}, op{op} {
+            keep(1);
+            if (isSmall(k)) {
+                direct.reset(new SmallKernel<Op>(k, m, n, op));
+                src.keep(direct->height());
+                return;
+            }
+
+            int top = 0, bottom = 0, L = 1;
+            std::vector<Box> boxes{decompose(k)};
+            if (!boxes.empty()) top = boxes[0].top, bottom = boxes[0].bottom;
+            for (auto &b : boxes) {
+                int V{b.bottom - b.top + 1};
+                lanes.push_back({b, V, std::vector<uchar>(static_cast<std::size_t>(V) * n), std::vector<uchar>(static_cast<std::size_t>(V) * n), std::vector<uchar>(n)});
+                top = std::min(top, b.top), bottom = std::max(bottom, b.bottom);
+                L = std::max(L, b.right - b.left + 1);
+            }
+            src.keep(bottom - top + 1);
+            lg.resize(n + 2 * L), lh.resize(n + 2 * L);
+        }
+
+        void keep(int d) override {
+            if (d > depth) {
+                depth = d;
+                out.resize(static_cast<std::size_t>(depth) * n);
+            }
+        }
+
+        const uchar *row(int i) override {
+            while (next <= i) produce(next++);
+            return &out[static_cast<std::size_t>(i % depth) * n];
+        }
+
+       private:
+        struct Lane {
+            Box b;
+            int V;
+            std::vector<uchar> a, H, g;
+        };
+
+        // padded input row t of the lane's vertical pass, i.e. image row t + top
+        void fetch(Lane &l, int t) {
+            const uchar id{Op::identity};
+            uchar *at{&l.a[static_cast<std::size_t>(t % l.V) * n]};
+            int s{t + l.b.top};
+            if (s >= 0 && s < m)
+                line(src.row(s), 1, n, l.b.left, l.b.right, at, 1, lg.data(), lh.data(), op);
+            else
+                std::fill(at, at + n, id);
+
+            uchar *g{l.g.data()};
+            if (t % l.V == 0) {
+                std::copy(at, at + n, g);
+            } else {
+                for (int j = 0; j < n; j++) g[j] = op(g[j], at[j]);
+            }
+        }
+
+        void produce(int x) {
+            const uchar id{Op::identity};
+            uchar *dst{&out[static_cast<std::size_t>(x % depth) * n]};
+            if (direct) {
+                direct->row([&](int y) { return src.row(y); }, x, dst);
+                return;
+            }
+
+            std::fill(dst, dst + n, id);
+
+            for (auto &l : lanes) {
+                int V{l.V};
+                if (x == 0)
+                    for (int t = 0; t < V - 1; t++) fetch(l, t);
+                fetch(l, x + V - 1);
+
+                if (x % V == 0) {
+                    // the ring holds exactly this block now
+                    std::copy(&l.a[static_cast<std::size_t>(V - 1) * n], &l.a[static_cast<std::size_t>(V) * n], &l.H[static_cast<std::size_t>(V - 1) * n]);
+                    for (int r = V - 2; r >= 0; r--) {
+                        const uchar *a{&l.a[static_cast<std::size_t>(r) * n]}, *hn{&l.H[static_cast<std::size_t>(r + 1) * n]};
+                        uchar *h{&l.H[static_cast<std::size_t>(r) * n]};
+                        for (int j = 0; j < n; j++) h[j] = op(hn[j], a[j]);
+                    }
+                }
+
+                const uchar *h{&l.H[static_cast<std::size_t>(x % V) * n]}, *g{l.g.data()};
+                for (int j = 0; j < n; j++) dst[j] = op(dst[j], op(h[j], g[j]));
+            }
+        }
+
+        RowStream &src;
+        Op op;
+        std::unique_ptr<SmallKernel<Op>> direct;  // kernels within 5x5
+        std::vector<Lane> lanes;
+        std::vector<uchar> lg, lh, out;
+        int depth{0}, next{0};
+    };
+
+    struct Step {
+        enum Kind { Erode, Dilate } kind;
+        Kernel k;
+    };
+
+    inline cv::Mat materialize(RowStream &s) {
+        int m = s.rows(), n = s.cols();
+        cv::Mat image_(m, n, CV_8UC1);
+        for (int i = 0; i < m; i++) {
+            std::memcpy(image_.ptr<uchar>(i), s.row(i), n);
+        }
+
+        return image_;
+    }
+
+    inline cv::Mat pipeline(const cv::Mat &image, const std::vector<Step> &steps) {
+        std::vector<std::unique_ptr<RowStream>> stages;
+        stages.emplace_back(new MatStream(image));
+        for (auto &s : steps) {
+            RowStream &src{*stages.back()};
+            if (s.kind == Step::Dilate)
+                stages.emplace_back(new FilterStream<Max>(src, s.k, Max{}));
+            else
+                stages.emplace_back(new FilterStream<Min>(src, s.k, Min{}));
+        }
+
+        return materialize(*stages.back());
+    }
+
+    // dst[j] = a[j] - b[j], saturated at 0
+    inline void difference(uchar *dst, const uchar *a, const uchar *b, int n) {
+        int j = 0;
+#if defined(__AVX2__)
+        for (; j + 32 <= n; j += 32) {
+            __m256i va{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + j))};
+            __m256i vb{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + j))};
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + j), _mm256_subs_epu8(va, vb));
+        }
+#elif defined(__SSE2__)
+        for (; j + 16 <= n; j += 16) {
+            __m128i va{_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + j))};
+            __m128i vb{_mm_loadu_si128(reinterpret_cast<const __m128i *>(b + j))};
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + j), _mm_subs_epu8(va, vb));
+        }
+#endif
+        for (; j < n; j++) {
+            dst[j] = a[j] > b[j] ? a[j] - b[j] : 0;
+        }
+    }
+
+    // One-sided gradients and top-hats: both operands are streams over the
+    // same source rows and are subtracted row by row as they are produced, so
+    // the input is swept once and the output is the only image allocated.
+    inline cv::Mat difference(RowStream &a, RowStream &b) {
+        int m = a.rows(), n = a.cols();
+        cv::Mat image_(m, n, CV_8UC1);
+
+        for (int i = 0; i < m; i++) {
+            difference(image_.ptr<uchar>(i), a.row(i), b.row(i), n);
+        }
+
+        return image_;
+    }
+
+    // Dilation minus erosion by one kernel as a single stream. Every box lane
+    // keeps its max and min rings side by side and fills both from the same
+    // source rows with one van Herk/Gil-Werman scan, and the difference is
+    // written straight into the output row. Kernels within 5x5 run the two
+    // SmallKernels on the same source rows.
+    class GradientStream : public RowStream {
+       public:
+        GradientStream(RowStream &source, const Kernel &k) : RowStream(source.rows(), source.cols()), src{source}, hi(source.cols()), lo(source.cols()) {
+            keep(1);
+            if (isSmall(k)) {
+                dmax.reset(new SmallKernel<Max>(k, m, n, Max{}));
+                dmin.reset(new SmallKernel<Min>(k, m, n, Min{}));
+                src.keep(dmax->height());
+                return;
+            }
+
+            int top = 0, bottom = 0, L = 1;
+            std::vector<Box> boxes{decompose(k)};
+            if (!boxes.empty()) top = boxes[0].top, bottom = boxes[0].bottom;
+            for (auto &b : boxes) {
+                int V{b.bottom - b.top + 1};
+                std::size_t ring{static_cast<std::size_t>(V) * n};
+                lanes.push_back({b, V, std::vector<uchar>(ring), std::vector<uchar>(ring), std::vector<uchar>(ring), std::vector<uchar>(ring), std::vector<uchar>(n), std::vector<uchar>(n)});
+                top = std::min(top, b.top), bottom = std::max(bottom, b.bottom);
+                L = std::max(L, b.right - b.left + 1);
+            }
+            src.keep(bottom - top + 1);
+            lg.resize(2 * (n + 2 * L)), lh.resize(2 * (n + 2 * L));
+        }
+
+        void keep(int d) override {
+            if (d > depth) {
+                depth = d;
+                out.resize(static_cast<std::size_t>(depth) * n);
+            }
+        }
+
+        const uchar *row(int i) override {
+            while (next <= i) produce(next++);
+            return &out[static_cast<std::size_t>(i % depth) * n];
+        }
+
+       private:
+        // ax/an are the max and min rings, Hx/Hn their suffix rows and gx/gn
+        // their running prefix rows
+        struct Lane {
+            Box b;
+            int V;
+            std::vector<uchar> ax, an, Hx, Hn, gx, gn;
+        };
+
+        void fetch(Lane &l, int t) {
+            std::size_t r{static_cast<std::size_t>(t % l.V) * n};
+            uchar *ax{&l.ax[r]}, *an{&l.an[r]};
+            int s{t + l.b.top};
+            if (s >= 0 && s < m) {
+                line(src.row(s), n, l.b.left, l.b.right, ax, an, lg.data(), lh.data());
+            } else {
+                std::fill(ax, ax + n, Max::identity);
+                std::fill(an, an + n, Min::identity);
+            }
+
+            uchar *gx{l.gx.data()}, *gn{l.gn.data()};
+            if (t % l.V == 0) {
+                std::copy(ax, ax + n, gx);
+                std::copy(an, an + n, gn);
+            } else {
+                for (int j = 0; j < n; j++) {
+                    gx[j] = std::max(gx[j], ax[j]);
+                    gn[j] = std::min(gn[j], an[j]);
+                }
+            }
+        }
+
+        void produce(int x) {
+            uchar *dst{&out[static_cast<std::size_t>(x % depth) * n]};
+            if (dmax) {
+                auto rows{[&](int y) { return src.row(y); }};
+                dmax->row(rows, x, hi.data());
+                dmin->row(rows, x, lo.data());
+                difference(dst, hi.data(), lo.data(), n);
+                return;
+            }
+
+            std::fill(hi.begin(), hi.end(), Max::identity);
+            std::fill(lo.begin(), lo.end(), Min::identity);
+
+            for (auto &l : lanes) {
+                int V{l.V};
+                if (x == 0)
+                    for (int t = 0; t < V - 1; t++) fetch(l, t);
+                fetch(l, x + V - 1);
+
+                if (x % V == 0) {
+                    // the rings hold exactly this block now
+                    std::size_t last{static_cast<std::size_t>(V - 1) * n};
+                    std::copy(&l.ax[last], &l.ax[last] + n, &l.Hx[last]);
+                    std::copy(&l.an[last], &l.an[last] + n, &l.Hn[last]);
+                    for (int r = V - 2; r >= 0; r--) {
+                        std::size_t o{static_cast<std::size_t>(r) * n};
+                        for (int j = 0; j < n; j++) {
+                            l.Hx[o + j] = std::max(l.Hx[o + n + j], l.ax[o + j]);
+                            l.Hn[o + j] = std::min(l.Hn[o + n + j], l.an[o + j]);
+                        }
+                    }
+                }
+
+                std::size_t o{static_cast<std::size_t>(x % V) * n};
+                for (int j = 0; j < n; j++) {
+                    hi[j] = std::max(hi[j], std::max(l.Hx[o + j], l.gx[j]));
+                    lo[j] = std::min(lo[j], std::min(l.Hn[o + j], l.gn[j]));
+                }
+            }
+
+            difference(dst, hi.data(), lo.data(), n);
+        }
+
+        RowStream &src;
+        std::unique_ptr<SmallKernel<Max>> dmax;  // kernels within 5x5
+        std::unique_ptr<SmallKernel<Min>> dmin;
+        std::vector<Lane> lanes;
+        std::vector<uchar> lg, lh, hi, lo, out;
+        int depth{0}, next{0};
+    };
+
+    // dilation - erosion
+    inline cv::Mat gradient(const cv::Mat &image, const Kernel &k) {
+        MatStream src(image);
+        GradientStream g(src, k);
+        return materialize(g);
+    }
+
+    // image - erosion
+    inline cv::Mat internalGradient(const cv::Mat &image, const Kernel &k) {
+        MatStream src(image);
+        FilterStream<Min> e(src, k, Min{});
+        return difference(src, e);
+    }
+
+    // dilation - image
+    inline cv::Mat externalGradient(const cv::Mat &image, const Kernel &k) {
+        MatStream src(image);
+        FilterStream<Max> d(src, k, Max{});
+        return difference(d, src);
+    }
+
+    // image - opening
+    inline cv::Mat whiteTopHat(const cv::Mat &image, const Kernel &k) {
+        MatStream src(image);
+        FilterStream<Min> e(src, k, Min{});
+        FilterStream<Max> o(e, k, Max{});
+        return difference(src, o);
+    }
+
+    // closing - image
+    inline cv::Mat blackTopHat(const cv::Mat &image, const Kernel &k) {
+        MatStream src(image);
+        FilterStream<Max> d(src, k, Max{});
+        FilterStream<Min> c(d, k, Min{});
+        return difference(c, src);
+    }
+
+    inline cv::Mat open(const cv::Mat &image, const Kernel &k) {
+        return pipeline(image, {{Step::Erode, k}, {Step::Dilate, k}});
+    }
+
+    inline cv::Mat close(const cv::Mat &image, const Kernel &k) {
+        return pipeline(image, {{Step::Dilate, k}, {Step::Erode, k}});
+    }
+}  // namespace Morphology
+
+#endif
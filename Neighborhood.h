@@ -0,0 +1,153 @@
+#ifndef NEIGHBORHOOD_H
+#define NEIGHBORHOOD_H
+
+#include <algorithm>
+#include <array>
+#include <opencv2/core.hpp>
+#include <vector>
+
+// 3x3 binary neighbourhoods as 9-bit codes. Pixel (i + dy, j + dx) sets bit
+// 3 * (dx + 1) + (dy + 1) when it is foreground (non-zero), so each column of
+// the window is three adjacent bits and moving one pixel right is
+// (code >> 3) | (entering column << 6). Any rule on a 3x3 window is then a
+// 512-entry table built once from a predicate, and applying it costs one
+// shift, one column read and one table load per pixel.
+namespace Neighborhood {
+    using Table = std::array<uchar, 512>;
+
+    constexpr int bit(int dy, int dx) {
+        return 3 * (dx + 1) + (dy + 1);
+    }
+
+    constexpr bool at(int code, int dy, int dx) {
+        return (code >> bit(dy, dx)) & 1;
+    }
+
+    // Yokoi's numbering: x0 centre, x1 right, x2 up, x3 left, x4 down,
+    // x5 up-right, x6 up-left, x7 down-left, x8 down-right.
+    constexpr int X[9][2]{{0, 0}, {0, 1}, {-1, 0}, {0, -1}, {1, 0}, {-1, 1}, {-1, -1}, {1, -1}, {1, 1}};
+
+    constexpr int x(int code, int k) {
+        return at(code, X[k][0], X[k][1]) ? 1 : 0;
+    }
+
+    // h(x0, c, d, e) over the four corner quadrants a1..a4, for Yokoi-style rules.
+    template <class H>
+    std::vector<char> quadrants(int code, H h) {
+        constexpr int q[4][3]{{1, 5, 2}, {2, 6, 3}, {3, 7, 4}, {4, 8, 1}};
+        std::vector<char> a;
+        for (auto &c : q) a.push_back(h(x(code, 0), x(code, c[0]), x(code, c[1]), x(code, c[2])));
+        return a;
+    }
+
+    template <class F>
+    Table compile(F rule) {
+        Table t;
+        for (int code = 0; code < 512; code++) t[code] = static_cast<uchar>(rule(code));
+        return t;
+    }
+
+    // 1 where every hit offset is foreground and every miss offset background.
+    inline Table hitAndMiss(const std::vector<std::vector<int>> &hit, const std::vector<std::vector<int>> &miss) {
+        return compile([&](int code) {
+            for (auto &p : hit)
+                if (!at(code, p[0], p[1])) return 0;
+            for (auto &p : miss)
+                if (at(code, p[0], p[1])) return 0;
+            return 1;
+        });
+    }
+
+    // code of pixel (i, j) on its own; pixels outside the image are background
+    inline int code(const cv::Mat &image, int i, int j) {
+        int c = 0;
+        for (int dy = -1; dy <= 1; dy++) {
+            int y{i + dy};
+            if (y < 0 || y >= image.rows) continue;
+            const uchar *r{image.ptr<uchar>(y)};
+            for (int dx = -1; dx <= 1; dx++) {
+                int x{j + dx};
+                if (x >= 0 && x < image.cols && r[x]) c |= 1 << bit(dy, dx);
+            }
+        }
+        return c;
+    }
+
+    // Slides the window along row i; pixels outside the image are background.
+    class Window {
+       public:
+        Window(const cv::Mat &image, int i)
+            : up{i > 0 ? image.ptr<uchar>(i - 1) : nullptr},
+              mid{image.ptr<uchar>(i)},
+              down{i + 1 < image.rows ? image.ptr<uchar>(i + 1) : nullptr},
+              n{image.cols},
+              code{column(0) << 6} {}
+
+        // code of the next pixel of the row, starting at column 0
+        int next() {
+            j++;
+            code = (code >> 3) | (column(j + 1) << 6);
+            return code;
+        }
+
+        // call after writing pixel (i + dy, j + dx) so later codes see the new value
+        void update(int dy, int dx, bool foreground) {
+            if (foreground)
+                code |= 1 << bit(dy, dx);
+            else
+                code &= ~(1 << bit(dy, dx));
+        }
+
+       private:
+        int column(int c) const {
+            if (c >= n) return 0;
+            return (up && up[c] ? 1 : 0) | (mid[c] ? 2 : 0) | (down && down[c] ? 4 : 0);
+        }
+
+        const uchar *up, *mid, *down;
+        int n, j{-1}, code;
+    };
+
+    // cols[j] = column j of the window centred on row i as 3 bits, cols[n] = 0
+    inline void columns(const cv::Mat &image, int i, uchar *cols) {
+        int m = image.rows, n = image.cols;
+        const uchar *up{i > 0 ? image.ptr<uchar>(i - 1) : nullptr};
+        const uchar *mid{image.ptr<uchar>(i)};
+        const uchar *down{i + 1 < m ? image.ptr<uchar>(i + 1) : nullptr};
+
+        for (int j = 0; j < n; j++) cols[j] = mid[j] ? 2 : 0;
+        if (up)
+            for (int j = 0; j < n; j++) cols[j] |= up[j] ? 1 : 0;
+        if (down)
+            for (int j = 0; j < n; j++) cols[j] |= down[j] ? 4 : 0;
+        cols[n] = 0;
+    }
+
+    // out(i, j) = t[code of (i, j)], CV_8UC1. Rows are independent, so with
+    // bands > 1 the image is cut into that many row bands run in parallel.
+    inline cv::Mat apply(const cv::Mat &image, const Table &t, int bands = 1) {
+        int m = image.rows, n = image.cols;
+        cv::Mat image_(m, n, CV_8UC1);
+        bands = std::max(1, std::min(bands, m));
+
+        cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range &range) {
+            std::vector<uchar> cols(n + 1);
+            for (int b = range.start; b < range.end; b++) {
+                int r0{static_cast<int>(static_cast<long long>(m) * b / bands)}, r1{static_cast<int>(static_cast<long long>(m) * (b + 1) / bands)};
+                for (int i = r0; i < r1; i++) {
+                    columns(image, i, cols.data());
+                    uchar *dst{image_.ptr<uchar>(i)};
+                    int code{cols[0] << 6};
+                    for (int j = 0; j < n; j++) {
+                        code = (code >> 3) | (cols[j + 1] << 6);
+                        dst[j] = t[code];
+                    }
+                }
+            }
+        });
+
+        return image_;
+    }
+}  // namespace Neighborhood
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef POINTOP_H
+#define POINTOP_H
+
+#include <array>
+#include <opencv2/core.hpp>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+// A uchar -> uchar point operation stored as a 256-entry lookup table.
+// Chains are composed when they are built (a.then(b) is one table), so any
+// sequence of thresholds, complements, scalings and equalizations is applied
+// to an image in a single pass.
+class PointOp {
+   public:
+    using Table = std::array<uchar, 256>;
+
+    PointOp() {
+        for (int v = 0; v < 256; v++) lut[v] = v;
+    }
+
+    template <class F>
+    static PointOp fromFunction(F f) {
+        PointOp op;
+        for (int v = 0; v < 256; v++) op.lut[v] = static_cast<uchar>(f(v));
+        return op;
+    }
+
+    // v >= threshold ? 255 : 0
+    static PointOp threshold(int threshold) {
+        return fromFunction([=](int v) { return (v >= threshold) ? 255 : 0; });
+    }
+
+    // binary complement: 255 -> 0, everything else -> 255
+    static PointOp complement() {
+        return fromFunction([](int v) { return (v == 0xFF) ? 0 : 0xFF; });
+    }
+
+    static PointOp divide(int d) {
+        return fromFunction([=](int v) { return v / d; });
+    }
+
+    // Global histogram equalization: 255 * CDF(v), truncated.
+    template <class Count>
+    static PointOp equalize(const std::array<Count, 256> &freq) {
+        double N = 0, T = 0;
+        for (Count f : freq) N += f;
+
+        PointOp op;
+        for (int v = 0; v < 256; v++) {
+            T += freq[v] / N;
+            op.lut[v] = static_cast<uchar>(255 * T);
+        }
+        return op;
+    }
+
+    // (*this).then(next) maps v to next(this(v)).
+    PointOp then(const PointOp &next) const {
+        PointOp op;
+        for (int v = 0; v < 256; v++) op.lut[v] = next.lut[lut[v]];
+        return op;
+    }
+
+    uchar operator()(uchar v) const { return lut[v]; }
+    const Table &table() const { return lut; }
+
+    void apply(const uchar *src, uchar *dst, int n) const {
+        int j = 0;
+#if defined(__AVX2__)
+        __m256i t[16];
+        for (int k = 0; k < 16; k++)
+            t[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lut.data() + 16 * k)));
+        const __m256i lowNibble{_mm256_set1_epi8(0x0F)};
+        for (; j + 32 <= n; j += 32) {
+            __m256i v{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + j))};
+            __m256i lo{_mm256_and_si256(v, lowNibble)};
+            __m256i hi{_mm256_and_si256(_mm256_srli_epi16(v, 4), lowNibble)};
+            __m256i r{_mm256_setzero_si256()};
+            for (int k = 0; k < 16; k++) {
+                __m256i hit{_mm256_cmpeq_epi8(hi, _mm256_set1_epi8(k))};
+                r = _mm256_or_si256(r, _mm256_and_si256(hit, _mm256_shuffle_epi8(t[k], lo)));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + j), r);
+        }
+#elif defined(__SSSE3__)
+        __m128i t[16];
+        for (int k = 0; k < 16; k++)
+            t[k] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lut.data() + 16 * k));
+        const __m128i lowNibble{_mm_set1_epi8(0x0F)};
+        for (; j + 16 <= n; j += 16) {
+            __m128i v{_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + j))};
+            __m128i lo{_mm_and_si128(v, lowNibble)};
+            __m128i hi{_mm_and_si128(_mm_srli_epi16(v, 4), lowNibble)};
+            __m128i r{_mm_setzero_si128()};
+            for (int k = 0; k < 16; k++) {
+                __m128i hit{_mm_cmpeq_epi8(hi, _mm_set1_epi8(k))};
+                r = _mm_or_si128(r, _mm_and_si128(hit, _mm_shuffle_epi8(t[k], lo)));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + j), r);
+        }
+#endif
+        for (; j < n; j++) {
+            dst[j] = lut[src[j]];
+        }
+    }
+
+    cv::Mat apply(const cv::Mat &image) const {
+        int m = image.rows, n = image.cols;
+        cv::Mat image_(m, n, CV_8UC1);
+
+        for (int i = 0; i < m; i++) {
+            apply(image.ptr<uchar>(i), image_.ptr<uchar>(i), n);
+        }
+
+        return image_;
+    }
+
+   private:
+    Table lut;
+};
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef STRUCTURINGELEMENT_H
+#define STRUCTURINGELEMENT_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Structuring elements whose offsets are known at compile time. A shape is a
+// constexpr Taps array, and StructuringElement<Shape> exposes its bounds as
+// constants and reduces a pixel's taps in one fully unrolled expression, so
+// filters can split the image into a branch-free interior and a border ring.
+struct Offset {
+    int dy, dx;
+};
+
+template <std::size_t N>
+using Taps = std::array<Offset, N>;
+
+// 5x5 square without its corners
+constexpr Taps<21> octagonTaps() {
+    Taps<21> taps{};
+    std::size_t k = 0;
+    for (int i = -2; i <= 2; i++) {
+        for (int j = -2; j <= 2; j++) {
+            if (i * j != 4 && i * j != -4)
+                taps[k++] = {i, j};
+        }
+    }
+    return taps;
+}
+
+inline constexpr Taps<21> Octagon{octagonTaps()};
+
+template <const auto &Shape>
+struct StructuringElement {
+    static constexpr std::size_t size{Shape.size()};
+
+    static constexpr int bound(bool rows, bool upper) {
+        int v{rows ? Shape[0].dy : Shape[0].dx};
+        for (auto &o : Shape) {
+            int c{rows ? o.dy : o.dx};
+            v = upper ? std::max(v, c) : std::min(v, c);
+        }
+        return v;
+    }
+
+    static constexpr int top{bound(true, false)}, bottom{bound(true, true)};
+    static constexpr int left{bound(false, false)}, right{bound(false, true)};
+
+    // the same shape as a runtime {dy, dx} list
+    static std::vector<std::vector<int>> kernel() {
+        std::vector<std::vector<int>> k;
+        for (auto &o : Shape) k.push_back({o.dy, o.dx});
+        return k;
+    }
+
+    static constexpr int width{right - left + 1};
+
+    // Taps grouped by column offset: rows[s] are the distinct sets of row
+    // offsets (bit dy - top), and column left + c uses set[c], or none if -1.
+    struct Columns {
+        std::array<std::uint32_t, width> rows{};
+        std::array<int, width> set{};
+        int count{0};
+    };
+
+    static constexpr Columns columns() {
+        static_assert(bottom - top < 32, "row offsets must fit a 32-bit mask");
+        Columns g{};
+        for (int c = 0; c < width; c++) {
+            std::uint32_t r{0};
+            for (auto &o : Shape)
+                if (o.dx == left + c) r |= std::uint32_t{1} << (o.dy - top);
+            g.set[c] = -1;
+            if (r == 0) continue;
+            int s{0};
+            while (s < g.count && g.rows[s] != r) s++;
+            if (s == g.count) g.rows[g.count++] = r;
+            g.set[c] = s;
+        }
+        return g;
+    }
+
+    // op over p[dy * step + dx] for every tap, starting from init; the caller
+    // guarantees every tap is inside the image.
+    template <class T, class Op>
+    static T reduce(const T *p, std::ptrdiff_t step, T init, Op op) {
+        return reduce(p, step, init, op, std::make_index_sequence<size>{});
+    }
+
+    template <class F>
+    static void forEach(F f) {
+        forEach(f, std::make_index_sequence<size>{});
+    }
+
+   private:
+    template <class T, class Op, std::size_t... I>
+    static T reduce(const T *p, std::ptrdiff_t step, T v, Op op, std::index_sequence<I...>) {
+        ((v = op(v, p[Shape[I].dy * step + Shape[I].dx])), ...);
+        return v;
+    }
+
+    template <class F, std::size_t... I>
+    static void forEach(F f, std::index_sequence<I...>) {
+        (f(Shape[I]), ...);
+    }
+};
+
+using OctagonSE = StructuringElement<Octagon>;
+
+#endif
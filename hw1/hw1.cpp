@@ -3,50 +3,35 @@
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 
+#include "../Flip.h"
+#include "../ImageView.h"
+#include "../PointOp.h"
+
 const cv::String Input_image{"../lena.bmp"};
 
 cv::Mat upsideDown(const cv::Mat &image) {
-    int m = image.rows, n = image.cols;
-    cv::Mat image_(m, n, CV_8UC1, cv::Scalar::all(0));
-
-    for (int i{}; i < m; i++) {
-        const uchar *src{image.ptr<uchar>(i)};
-        uchar *dst{image_.ptr<uchar>(m - i - 1)};
-        for (int j{}; j < n; j++) {
-            dst[j] = src[j];
-        }
-    }
-
-    return image_;
+    return ImageView(image).flipUpDown().materialize();
 }
 
 cv::Mat rightSideLeft(const cv::Mat &image) {
-    int m = image.rows, n = image.cols;
-    cv::Mat image_(m, n, CV_8UC1, cv::Scalar::all(0));
-
-    for (int i{}; i < m; i++) {
-        const uchar *src{image.ptr<uchar>(i)};
-        uchar *dst{image_.ptr<uchar>(i)};
-        for (int j{}; j < n; j++) {
-            dst[j] = src[n - j - 1];
-        }
-    }
-
-    return image_;
+    return ImageView(image).flipLeftRight().materialize();
 }
 
 cv::Mat diagonallyFlip(const cv::Mat &image) {
-    int m = image.rows, n = image.cols;
-    cv::Mat image_(m, n, CV_8UC1, cv::Scalar::all(0));
+    return ImageView(image).transpose().materialize();
+}
 
-    for (int i{}; i < m; i++) {
-        const uchar *src{image.ptr<uchar>(i)};
-        for (int j{}; j < n; j++) {
-            image_.at<uchar>(j, i) = src[j];
-        }
-    }
+void upsideDownInPlace(cv::Mat &image) {
+    Flip::flipRowsInPlace(image);
+}
 
-    return image_;
+void rightSideLeftInPlace(cv::Mat &image) {
+    Flip::flipColsInPlace(image);
+}
+
+// square images only
+void diagonallyFlipInPlace(cv::Mat &image) {
+    Flip::transposeInPlace(image);
 }
 
 cv::Mat rotate(const cv::Mat &image, double theta) {
@@ -68,15 +53,19 @@ cv::Mat shrinkHalf(const cv::Mat &image) {
     return image_;
 }
 
-cv::Mat binarize(const cv::Mat &image, int threshold) {
-    int m = image.rows, n = image.cols;
-    cv::Mat image_(m, n, CV_8UC1, cv::Scalar::all(0));
+cv::Mat binarize(const ImageView &image, int threshold) {
+    int m = image.rows(), n = image.cols();
+    cv::Mat image_(m, n, CV_8UC1);
+    PointOp op{PointOp::threshold(threshold + 1)};
 
     for (int i{}; i < m; i++) {
-        const uchar *src{image.ptr<uchar>(i)};
         uchar *dst{image_.ptr<uchar>(i)};
-        for (int j{}; j < n; j++) {
-            dst[j] = (src[j] > threshold) ? 255 : 0;
+        if (image.isRowContiguous()) {
+            op.apply(image.row(i), dst, n);
+        } else {
+            for (int j{}; j < n; j++) {
+                dst[j] = op(image(i, j));
+            }
         }
     }
 
@@ -1,35 +1,81 @@
 #ifndef DISJOINTSET_H
 #define DISJOINTSET_H
 
-#include <numeric>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
 #include <vector>
 
+// Union-find over 0..n packed into one 32-bit word per element: a word >= 0
+// is the parent index, a negative word marks a root and stores -(rank + 1).
+// find_parent uses iterative path halving, and union_set links roots with a
+// compare-and-swap on the child's root word, so both are safe to call from
+// many threads at once (Jayanti-Tarjan style concurrent union by rank).
 class DisjointSet {
    public:
-    DisjointSet(int n) {
-        parent.resize(n + 1);
-        sz.resize(n + 1, 1);
-        std::iota(begin(parent), end(parent), 0);
+    DisjointSet(int n) : node(n + 1) {
+        for (auto &w : node) w.store(-1, std::memory_order_relaxed);
     }
 
+    int size() const { return static_cast<int>(node.size()) - 1; }
+
     int find_parent(int x) {
-        if (x != parent[x])
-            parent[x] = find_parent(parent[x]);
-        return parent[x];
+        while (true) {
+            int p{node[x].load(std::memory_order_relaxed)};
+            if (p < 0) return x;
+            int gp{node[p].load(std::memory_order_relaxed)};
+            if (gp < 0) return p;
+            // halve the path: x is not a root and gp is an ancestor of x, so a
+            // racing store can only leave a shorter or longer valid path
+            node[x].store(gp, std::memory_order_relaxed);
+            x = gp;
+        }
+    }
+
+    // Returns false if x and y were already in the same set.
+    bool union_set(int x, int y) {
+        while (true) {
+            int a{find_parent(x)}, b{find_parent(y)};
+            if (a == b) return false;
+
+            int wa{node[a].load(std::memory_order_relaxed)}, wb{node[b].load(std::memory_order_relaxed)};
+            if (wa >= 0 || wb >= 0) continue;  // stopped being a root meanwhile
+
+            // rank(a) = -wa - 1; hang the lower-ranked root (ties: smaller index) below the other
+            if (wa > wb || (wa == wb && a < b)) {
+                std::swap(a, b);
+                std::swap(wa, wb);
+            }
+            if (!node[b].compare_exchange_strong(wb, a, std::memory_order_acq_rel)) continue;
+            if (wa == wb)
+                node[a].compare_exchange_strong(wa, wa - 1, std::memory_order_relaxed);
+            return true;
+        }
     }
 
-    void union_set(int x, int y) {
-        int a = find_parent(x);
-        int b = find_parent(y);
+    // Unites x[k] with y[k] for every k; the next pairs' words are prefetched
+    // while the current one is linked. Safe to run concurrently on disjoint
+    // slices of a larger batch.
+    void union_batch(const int *x, const int *y, std::size_t count) {
+        constexpr std::size_t ahead{8};
+        for (std::size_t k = 0; k < count; k++) {
+#if defined(__GNUC__)
+            if (k + ahead < count) {
+                __builtin_prefetch(&node[x[k + ahead]]);
+                __builtin_prefetch(&node[y[k + ahead]]);
+            }
+#endif
+            union_set(x[k], y[k]);
+        }
+    }
 
-        if (sz[a] < sz[b]) std::swap(a, b);
-        parent[b] = a;
-        sz[a] += sz[b];
+    void union_batch(const std::vector<std::pair<int, int>> &pairs) {
+        for (auto &p : pairs) union_set(p.first, p.second);
     }
 
    private:
-    std::vector<int> parent;
-    std::vector<int> sz;
+    std::vector<std::atomic<int32_t>> node;
 };
 
-#endif
\ No newline at end of file
+#endif
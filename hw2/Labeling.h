@@ -0,0 +1,341 @@
+#ifndef LABELING_H
+#define LABELING_H
+
+#include <algorithm>
+#include <climits>
+#include <opencv2/core.hpp>
+#include <vector>
+
+#include "DisjointSet.h"
+
+enum class Connectivity { Four = 4, Eight = 8 };
+
+// Per-component statistics gathered while the final labels are written.
+// Tables are indexed by label; entry 0 (background) stays empty.
+struct ComponentStats {
+    int area{0};
+    int top{INT_MAX}, left{INT_MAX}, bottom{-1}, right{-1};
+    long long sumX{0}, sumY{0}, sumXX{0}, sumXY{0}, sumYY{0};
+
+    void add(int i, int j) {
+        area++;
+        top = std::min(top, i);
+        left = std::min(left, j);
+        bottom = std::max(bottom, i);
+        right = std::max(right, j);
+        sumX += j;
+        sumY += i;
+        sumXX += static_cast<long long>(j) * j;
+        sumXY += static_cast<long long>(i) * j;
+        sumYY += static_cast<long long>(i) * i;
+    }
+
+    void merge(const ComponentStats &o) {
+        area += o.area;
+        top = std::min(top, o.top);
+        left = std::min(left, o.left);
+        bottom = std::max(bottom, o.bottom);
+        right = std::max(right, o.right);
+        sumX += o.sumX;
+        sumY += o.sumY;
+        sumXX += o.sumXX;
+        sumXY += o.sumXY;
+        sumYY += o.sumYY;
+    }
+
+    // integer centroid (x, y), truncated
+    cv::Point centroid() const { return cv::Point(sumX / area, sumY / area); }
+
+    // central second-order moments, normalized by area
+    double mu20() const { return static_cast<double>(sumXX) / area - static_cast<double>(sumX) / area * sumX / area; }
+    double mu02() const { return static_cast<double>(sumYY) / area - static_cast<double>(sumY) / area * sumY / area; }
+    double mu11() const { return static_cast<double>(sumXY) / area - static_cast<double>(sumX) / area * sumY / area; }
+};
+
+// Connected component labeling into a flat CV_32SC1 label buffer.
+// Foreground is any non-zero pixel and background stays 0. Components get
+// labels 1..count in scan order: raster order of their first pixel for
+// 4-connectivity, raster order of their first 2x2 block for 8-connectivity.
+namespace Labeling {
+    inline int merge(DisjointSet &ds, int a, int b) {
+        ds.union_set(a, b);
+        return a;
+    }
+
+    // SAUF-style scan: with 4-connectivity only the up (q) and left (s)
+    // neighbours matter, and they are already equivalent when the up-left
+    // pixel (p) is foreground. Scans rows [r0, r1) as if nothing lay above r0,
+    // handing out provisional labels first + 1, first + 2, ...; returns the
+    // last one used.
+    inline int scan4(const cv::Mat &image, cv::Mat &label, DisjointSet &ds, int r0, int r1, int first) {
+        int n = image.cols;
+        int counter{first};
+
+        for (int i = r0; i < r1; i++) {
+            const uchar *row{image.ptr<uchar>(i)}, *rowUp{i > r0 ? image.ptr<uchar>(i - 1) : nullptr};
+            int *lab{label.ptr<int>(i)}, *labUp{i > r0 ? label.ptr<int>(i - 1) : nullptr};
+            for (int j = 0; j < n; j++) {
+                if (row[j] == 0) {
+                    lab[j] = 0;
+                    continue;
+                }
+                bool q{rowUp && rowUp[j]}, s{j > 0 && row[j - 1]};
+                if (q) {
+                    lab[j] = labUp[j];
+                    if (s && !rowUp[j - 1])
+                        merge(ds, labUp[j], lab[j - 1]);
+                } else if (s) {
+                    lab[j] = lab[j - 1];
+                } else {
+                    lab[j] = ++counter;
+                }
+            }
+        }
+
+        return counter;
+    }
+
+    // Block-based scan over 2x2 blocks (BBDT family). For the current block X
+    // with pixels a b / c d, the neighbouring blocks P (up-left), Q (up),
+    // R (up-right) and S (left) are tested in that decision-tree order; a merge
+    // is skipped whenever the two neighbours already touch through a shared
+    // foreground pixel, since they were unified when the earlier block was seen.
+    // Block labels are stored at each block's top-left pixel; r0 must be even.
+    inline int scan8(const cv::Mat &image, cv::Mat &label, DisjointSet &ds, int r0, int r1, int first) {
+        int n = image.cols;
+        int counter{first};
+
+        for (int i = r0; i < r1; i += 2) {
+            const uchar *row0{image.ptr<uchar>(i)};
+            const uchar *row1{i + 1 < r1 ? image.ptr<uchar>(i + 1) : nullptr};
+            const uchar *rowUp{i > r0 ? image.ptr<uchar>(i - 1) : nullptr};
+            int *lab{label.ptr<int>(i)}, *labUp{i > r0 ? label.ptr<int>(i - 2) : nullptr};
+
+            auto px{[n](const uchar *row, int x) { return row && x >= 0 && x < n && row[x] != 0; }};
+
+            for (int j = 0; j < n; j += 2) {
+                bool a{px(row0, j)}, b{px(row0, j + 1)}, c{px(row1, j)}, d{px(row1, j + 1)};
+                if (!(a || b || c || d)) {
+                    lab[j] = 0;
+                    continue;
+                }
+
+                bool p{px(rowUp, j - 1)}, q0{px(rowUp, j)}, q1{px(rowUp, j + 1)}, r{px(rowUp, j + 2)};
+                bool s0{px(row0, j - 1)}, s1{px(row1, j - 1)};
+
+                bool connP{p && a}, connQ{(q0 || q1) && (a || b)}, connR{r && b}, connS{(s0 || s1) && (a || c)};
+                int x = 0;
+
+                if (connQ) {
+                    x = labUp[j];
+                    if (connP && !q0) merge(ds, x, labUp[j - 2]);
+                    if (connR && !q1) merge(ds, x, labUp[j + 2]);
+                    if (connS && !(s0 && q0)) merge(ds, x, lab[j - 2]);
+                } else if (connP) {
+                    x = labUp[j - 2];
+                    if (connR) merge(ds, x, labUp[j + 2]);
+                    if (connS && !(s0 && p)) merge(ds, x, lab[j - 2]);
+                } else if (connR) {
+                    x = labUp[j + 2];
+                    if (connS) merge(ds, x, lab[j - 2]);
+                } else if (connS) {
+                    x = lab[j - 2];
+                } else {
+                    x = ++counter;
+                }
+                lab[j] = x;
+            }
+        }
+
+        return counter;
+    }
+
+    // Unifies the labels of strips meeting between rows r - 1 and r.
+    inline void mergeBorder(const cv::Mat &image, const cv::Mat &label, DisjointSet &ds, int r, Connectivity connectivity) {
+        int n = image.cols;
+        const uchar *up{image.ptr<uchar>(r - 1)}, *down{image.ptr<uchar>(r)};
+
+        if (connectivity == Connectivity::Four) {
+            const int *labUp{label.ptr<int>(r - 1)}, *labDown{label.ptr<int>(r)};
+            for (int j = 0; j < n; j++) {
+                if (up[j] && down[j])
+                    merge(ds, labUp[j], labDown[j]);
+            }
+            return;
+        }
+
+        // 8-connectivity: pixels still carry their block's label at the block origin
+        const int *labUp{label.ptr<int>(r - 2)}, *labDown{label.ptr<int>(r)};
+        for (int j = 0; j < n; j++) {
+            if (!down[j]) continue;
+            for (int x = std::max(j - 1, 0); x <= std::min(j + 1, n - 1); x++) {
+                if (up[x])
+                    merge(ds, labUp[x & ~1], labDown[j & ~1]);
+            }
+        }
+    }
+
+    // Writes final labels over rows [r0, r1). If stats is given, pixels of
+    // provisional label l are accumulated into (*stats)[slot[l]].
+    inline void relabel(const cv::Mat &image, cv::Mat &label, const std::vector<int> &final, const std::vector<int> &slot,
+                        int r0, int r1, Connectivity connectivity, std::vector<ComponentStats> *stats) {
+        int n = image.cols;
+
+        if (connectivity == Connectivity::Four) {
+            for (int i = r0; i < r1; i++) {
+                int *lab{label.ptr<int>(i)};
+                for (int j = 0; j < n; j++) {
+                    if (stats && lab[j] != 0)
+                        (*stats)[slot[lab[j]]].add(i, j);
+                    lab[j] = final[lab[j]];
+                }
+            }
+            return;
+        }
+
+        // spread each block's final label over its foreground pixels
+        for (int i = r0; i < r1; i += 2) {
+            const uchar *row0{image.ptr<uchar>(i)};
+            const uchar *row1{i + 1 < r1 ? image.ptr<uchar>(i + 1) : nullptr};
+            int *lab0{label.ptr<int>(i)}, *lab1{i + 1 < r1 ? label.ptr<int>(i + 1) : nullptr};
+            for (int j = 0; j < n; j += 2) {
+                int l{lab0[j]}, x{final[l]};
+                lab0[j] = row0[j] ? x : 0;
+                if (j + 1 < n) lab0[j + 1] = row0[j + 1] ? x : 0;
+                if (row1) {
+                    lab1[j] = row1[j] ? x : 0;
+                    if (j + 1 < n) lab1[j + 1] = row1[j + 1] ? x : 0;
+                }
+                if (stats && x != 0) {
+                    ComponentStats &c{(*stats)[slot[l]]};
+                    if (row0[j]) c.add(i, j);
+                    if (j + 1 < n && row0[j + 1]) c.add(i, j + 1);
+                    if (row1 && row1[j]) c.add(i + 1, j);
+                    if (row1 && j + 1 < n && row1[j + 1]) c.add(i + 1, j + 1);
+                }
+            }
+        }
+    }
+
+    // Strip-parallel labeling: horizontal strips are scanned concurrently, each
+    // with its own disjoint range of provisional labels in one shared
+    // DisjointSet, then the strip borders are merged in order. Because
+    // provisional labels are ordered by strip and then by scan position, the
+    // final labels are identical for any number of strips.
+    // If stats is given it receives count + 1 entries, one per label.
+    inline int labelParallel(const cv::Mat &image, cv::Mat &label, Connectivity connectivity, int strips,
+                             std::vector<ComponentStats> *stats = nullptr) {
+        int m = image.rows, n = image.cols;
+        label.create(m, n, CV_32SC1);
+        if (stats) stats->assign(1, ComponentStats{});
+        if (m == 0 || n == 0) return 0;
+
+        // strip boundaries; kept even so 2x2 blocks never straddle two strips
+        strips = std::max(1, std::min(strips, (m + 1) / 2));
+        std::vector<int> rowBegin(strips + 1), first(strips + 1, 0), last(strips);
+        for (int s = 0; s <= strips; s++) {
+            rowBegin[s] = std::min(m, static_cast<int>((static_cast<long long>(m) * s / strips + 1) & ~1LL));
+        }
+        rowBegin[strips] = m;
+        for (int s = 0; s < strips; s++) {
+            int h{rowBegin[s + 1] - rowBegin[s]};
+            int maxLabels{(connectivity == Connectivity::Four) ? (h * n + 1) / 2 : ((h + 1) / 2) * ((n + 1) / 2)};
+            first[s + 1] = first[s] + maxLabels;
+        }
+
+        DisjointSet ds(first[strips]);
+
+        cv::parallel_for_(cv::Range(0, strips), [&](const cv::Range &range) {
+            for (int s = range.start; s < range.end; s++) {
+                last[s] = (connectivity == Connectivity::Four)
+                              ? scan4(image, label, ds, rowBegin[s], rowBegin[s + 1], first[s])
+                              : scan8(image, label, ds, rowBegin[s], rowBegin[s + 1], first[s]);
+            }
+        });
+
+        for (int s = 1; s < strips; s++) {
+            if (rowBegin[s] > rowBegin[s - 1] && rowBegin[s] < m)
+                mergeBorder(image, label, ds, rowBegin[s], connectivity);
+        }
+
+        // Final labels are handed out strip by strip, so a strip only sees
+        // the labels it introduced, [own[s], own[s + 1]), plus the few earlier
+        // ones it was merged with across a border. Its stats table holds
+        // exactly those: own labels first, then the shared ones; slot maps
+        // each provisional label to its entry.
+        // Provisional labels that were never handed out map to themselves and
+        // therefore to a final label of their own; skip them.
+        std::vector<int> final(first[strips] + 1, 0), slot(stats ? first[strips] + 1 : 0, 0);
+        std::vector<int> own(strips + 1, 1), seen(stats ? first[strips] + 1 : 0, -1);
+        std::vector<std::vector<int>> shared(stats ? strips : 0);
+        int count = 0;
+        for (int s = 0; s < strips; s++) {
+            own[s] = count + 1;
+            for (int l = first[s] + 1; l <= last[s]; l++) {
+                int root{ds.find_parent(l)};
+                if (final[root] == 0)
+                    final[root] = ++count;
+                final[l] = final[root];
+            }
+            own[s + 1] = count + 1;
+            if (!stats) continue;
+
+            for (int l = first[s] + 1; l <= last[s]; l++) {
+                int x{final[l]};
+                if (x >= own[s]) {
+                    slot[l] = x - own[s];
+                    continue;
+                }
+                if (seen[x] != s) {
+                    seen[x] = s;
+                    shared[s].push_back(x);
+                }
+            }
+            // shared slots follow the own ones, in the order first met
+            for (std::size_t k = 0; k < shared[s].size(); k++) seen[shared[s][k]] = static_cast<int>(k);
+            for (int l = first[s] + 1; l <= last[s]; l++) {
+                if (final[l] < own[s]) slot[l] = own[s + 1] - own[s] + seen[final[l]];
+            }
+            for (int x : shared[s]) seen[x] = -1;
+        }
+
+        // all sums are integers, so the result does not depend on the strip count
+        std::vector<std::vector<ComponentStats>> partial(stats ? strips : 0);
+
+        cv::parallel_for_(cv::Range(0, strips), [&](const cv::Range &range) {
+            for (int s = range.start; s < range.end; s++) {
+                if (stats) partial[s].resize(own[s + 1] - own[s] + shared[s].size());
+                relabel(image, label, final, slot, rowBegin[s], rowBegin[s + 1], connectivity, stats ? &partial[s] : nullptr);
+            }
+        });
+
+        if (stats) {
+            stats->resize(count + 1);
+            // own ranges are disjoint; the shared entries are folded in afterwards
+            cv::parallel_for_(cv::Range(0, strips), [&](const cv::Range &range) {
+                for (int s = range.start; s < range.end; s++) {
+                    std::copy(partial[s].begin(), partial[s].begin() + (own[s + 1] - own[s]), stats->begin() + own[s]);
+                }
+            });
+            for (int s = 1; s < strips; s++) {
+                for (std::size_t k = 0; k < shared[s].size(); k++) {
+                    (*stats)[shared[s][k]].merge(partial[s][own[s + 1] - own[s] + k]);
+                }
+            }
+        }
+
+        return count;
+    }
+
+    // Labels image into label (allocated as CV_32SC1); returns the component count.
+    inline int label(const cv::Mat &image, cv::Mat &label, Connectivity connectivity = Connectivity::Four) {
+        return labelParallel(image, label, connectivity, 1);
+    }
+
+    inline int label(const cv::Mat &image, cv::Mat &label, std::vector<ComponentStats> &stats,
+                     Connectivity connectivity = Connectivity::Four) {
+        return labelParallel(image, label, connectivity, 1, &stats);
+    }
+}  // namespace Labeling
+
+#endif
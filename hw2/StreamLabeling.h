@@ -0,0 +1,149 @@
+#ifndef STREAMLABELING_H
+#define STREAMLABELING_H
+
+#include <functional>
+#include <istream>
+#include <numeric>
+#include <vector>
+
+#include "Labeling.h"
+
+// Row-by-row connected component labeling for images that do not fit in
+// memory. Only the previous and current row of labels are kept, plus a
+// union-find over the labels still touching the current row, so memory is
+// O(width + active components). A component's statistics are emitted as soon
+// as a row arrives that it does not reach, i.e. once it can no longer grow.
+class StreamLabeler {
+   public:
+    using Emit = std::function<void(const ComponentStats &)>;
+
+    StreamLabeler(int cols, Connectivity connectivity, Emit emit)
+        : n{cols}, conn{connectivity}, emit{std::move(emit)}, prev(cols, 0), cur(cols, 0) {}
+
+    // Labels the next row (cols bytes, non-zero is foreground).
+    void push(const uchar *row) {
+        for (int j = 0; j < n; j++) {
+            if (row[j] == 0) {
+                cur[j] = 0;
+                continue;
+            }
+
+            int x = 0;
+            if (conn == Connectivity::Four) {
+                int q{prev[j]}, s{j > 0 ? cur[j - 1] : 0};
+                x = q ? q : s;
+                if (q && s) unite(q, s);
+            } else {
+                int a{j > 0 ? prev[j - 1] : 0}, b{prev[j]}, c{j + 1 < n ? prev[j + 1] : 0}, d{j > 0 ? cur[j - 1] : 0};
+                if (b) {
+                    x = b;
+                } else if (c) {
+                    x = c;
+                    if (a) unite(c, a);
+                    else if (d) unite(c, d);
+                } else {
+                    x = a ? a : d;
+                }
+            }
+
+            if (x == 0) {
+                x = static_cast<int>(parent.size());
+                parent.push_back(x);
+                stats.emplace_back();
+            }
+            cur[j] = x;
+            stats[x].add(row_, j);
+        }
+
+        compact();
+        std::swap(prev, cur);
+        row_++;
+    }
+
+    // No more rows: every component still open is complete.
+    void finish() {
+        std::fill(cur.begin(), cur.end(), 0);
+        compact();
+        std::fill(prev.begin(), prev.end(), 0);
+    }
+
+    int rows() const { return row_; }
+
+   private:
+    int find(int x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+
+    void unite(int a, int b) {
+        a = find(a);
+        b = find(b);
+        if (a != b) parent[std::max(a, b)] = std::min(a, b);
+    }
+
+    // Folds every label into its root, emits roots absent from the current row
+    // and renumbers the survivors 1..k in order of appearance.
+    void compact() {
+        int size{static_cast<int>(parent.size())};
+        for (int l = 1; l < size; l++) {
+            int r{find(l)};
+            if (r != l) stats[r].merge(stats[l]);
+        }
+
+        remap.assign(size, 0);
+        std::vector<ComponentStats> active(1);
+        for (int j = 0; j < n; j++) {
+            if (cur[j] == 0) continue;
+            int r{find(cur[j])};
+            if (remap[r] == 0) {
+                remap[r] = static_cast<int>(active.size());
+                active.push_back(stats[r]);
+            }
+            cur[j] = remap[r];
+        }
+
+        for (int l = 1; l < size; l++) {
+            if (parent[l] == l && remap[l] == 0)
+                emit(stats[l]);
+        }
+
+        stats.swap(active);
+        parent.resize(stats.size());
+        std::iota(parent.begin(), parent.end(), 0);
+    }
+
+    int n;
+    Connectivity conn;
+    Emit emit;
+    int row_{0};
+    std::vector<int> prev, cur, remap;
+    std::vector<int> parent{0};
+    std::vector<ComponentStats> stats = std::vector<ComponentStats>(1);
+};
+
+// Pulls rows from next(row), which fills cols bytes and returns false at the
+// end of the stream, e.g. a reader over a file descriptor or socket.
+template <class Source>
+int labelRows(Source next, int cols, Connectivity connectivity, StreamLabeler::Emit emit) {
+    StreamLabeler labeler(cols, connectivity, std::move(emit));
+    std::vector<uchar> row(cols);
+
+    while (next(row.data())) {
+        labeler.push(row.data());
+    }
+    labeler.finish();
+
+    return labeler.rows();
+}
+
+// Raw 8-bit rows, cols bytes each, read until EOF.
+inline int labelStream(std::istream &is, int cols, Connectivity connectivity, StreamLabeler::Emit emit) {
+    return labelRows(
+        [&](uchar *row) { return static_cast<bool>(is.read(reinterpret_cast<char *>(row), cols)); },
+        cols, connectivity, std::move(emit));
+}
+
+#endif
@@ -0,0 +1,113 @@
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <opencv2/core.hpp>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "../utils.cpp"
+#include "DisjointSet.h"
+
+// The union-find hw2 used before DisjointSet was packed and made concurrent.
+class LegacyDisjointSet {
+   public:
+    LegacyDisjointSet(int n) {
+        parent.resize(n + 1);
+        sz.resize(n + 1, 1);
+        std::iota(begin(parent), end(parent), 0);
+    }
+
+    int find_parent(int x) {
+        if (x != parent[x])
+            parent[x] = find_parent(parent[x]);
+        return parent[x];
+    }
+
+    void union_set(int x, int y) {
+        int a = find_parent(x);
+        int b = find_parent(y);
+        if (a == b) return;
+
+        if (sz[a] < sz[b]) std::swap(a, b);
+        parent[b] = a;
+        sz[a] += sz[b];
+    }
+
+   private:
+    std::vector<int> parent;
+    std::vector<int> sz;
+};
+
+template <class DS>
+double unite(DS &ds, const std::vector<int> &x, const std::vector<int> &y) {
+    Timer t;
+    for (std::size_t k = 0; k < x.size(); k++) {
+        ds.union_set(x[k], y[k]);
+    }
+    return t.elapsed();
+}
+
+// canonical[k] = smallest element in k's set; two structures hold the same
+// partition exactly when their canonical arrays are equal
+template <class DS>
+std::vector<int> canonical(DS &ds, int n) {
+    std::vector<int> smallest(n + 1, 0), canon(n + 1, 0);
+    for (int k = 1; k <= n; k++) {
+        int r{ds.find_parent(k)};
+        if (smallest[r] == 0) smallest[r] = k;
+        canon[k] = smallest[r];
+    }
+    return canon;
+}
+
+int main() {
+    constexpr int N{1 << 22};
+    std::mt19937 rng{11533};
+    std::uniform_int_distribution<int> pick(1, N);
+
+    // random pairs and a labeling-like pattern (neighbours along a raster)
+    std::vector<int> rx(N), ry(N), gx(N), gy(N);
+    for (int k = 0; k < N; k++) {
+        rx[k] = pick(rng);
+        ry[k] = pick(rng);
+        gx[k] = k + 1;
+        gy[k] = std::max(1, k + 1 - ((k % 3 == 0) ? 1 : 2048));
+    }
+
+    for (auto &workload : {std::make_pair("random", std::make_pair(&rx, &ry)), std::make_pair("raster", std::make_pair(&gx, &gy))}) {
+        const auto &x{*workload.second.first}, &y{*workload.second.second};
+        LegacyDisjointSet legacy(N);
+        double tLegacy{unite(legacy, x, y)};
+
+        DisjointSet packed(N);
+        double tPacked{unite(packed, x, y)};
+
+        DisjointSet batch(N);
+        Timer t;
+        batch.union_batch(x.data(), y.data(), x.size());
+        double tBatch{t.elapsed()};
+
+        int threads{static_cast<int>(std::max(2u, std::thread::hardware_concurrency()))};
+        DisjointSet shared(N);
+        t.reset();
+        std::vector<std::thread> pool;
+        for (int k = 0; k < threads; k++) {
+            std::size_t b{x.size() * k / threads}, e{x.size() * (k + 1) / threads};
+            pool.emplace_back([&, b, e] { shared.union_batch(x.data() + b, y.data() + b, e - b); });
+        }
+        for (auto &th : pool) th.join();
+        double tShared{t.elapsed()};
+
+        // the sequential packed run is the reference partition
+        std::vector<int> reference{canonical(packed, N)};
+        bool match{canonical(legacy, N) == reference && canonical(batch, N) == reference && canonical(shared, N) == reference};
+
+        std::cout << workload.first << ": legacy " << tLegacy << "s, packed " << tPacked
+                  << "s, batch " << tBatch << "s, " << threads << " threads " << tShared << "s"
+                  << (match ? "" : "  [MISMATCH]") << std::endl;
+    }
+
+    return 0;
+}
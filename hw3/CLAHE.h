@@ -0,0 +1,127 @@
+#ifndef CLAHE_H
+#define CLAHE_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <opencv2/core.hpp>
+#include <vector>
+
+#include "../Histogram.h"
+
+// Contrast limited adaptive histogram equalization. The image is cut into
+// tilesX x tilesY tiles, each tile gets a clipped equalization LUT, and every
+// pixel blends the LUTs of its four nearest tile centres bilinearly. Tile
+// histograms are built in parallel and the per-pixel path is integer only,
+// with Q12 interpolation weights precomputed per row and per column.
+namespace CLAHE {
+    using Table = std::array<uchar, 256>;
+
+    // Clips hist at limit and spreads the excess evenly over all bins.
+    inline void clip(GrayscaleArray &hist, std::uint64_t limit) {
+        std::uint64_t clipped = 0;
+        for (auto &h : hist) {
+            if (h > limit) {
+                clipped += h - limit;
+                h = limit;
+            }
+        }
+
+        std::uint64_t batch{clipped / 256}, residual{clipped % 256};
+        for (auto &h : hist) h += batch;
+        if (residual) {
+            std::uint64_t step{std::max<std::uint64_t>(256 / residual, 1)};
+            for (std::uint64_t v = 0; v < 256 && residual > 0; v += step, residual--) hist[v]++;
+        }
+    }
+
+    inline Table equalize(const GrayscaleArray &hist, std::uint64_t pixels) {
+        Table lut;
+        std::uint64_t cdf = 0;
+        for (int v = 0; v < 256; v++) {
+            cdf += hist[v];
+            lut[v] = static_cast<uchar>(std::min<std::uint64_t>(255, (cdf * 255 + pixels / 2) / pixels));
+        }
+        return lut;
+    }
+
+    constexpr int Q{12}, One{1 << Q};
+
+    // Position of pixel centre x relative to the centres of tiles of size t:
+    // tile index lo (clamped), its right/lower neighbour hi, and weight w of hi
+    // in Q12, rounded to nearest.
+    struct Weight {
+        int lo, hi, w;
+    };
+
+    inline std::vector<Weight> weights(int length, int t, int tiles) {
+        std::vector<Weight> ws(length);
+        for (int x = 0; x < length; x++) {
+            // (x + 0.5) / t - 0.5 = ((2x + 1) - t) / 2t
+            int pos{static_cast<int>((((2LL * x + 1) << Q) + t) / (2LL * t)) - One / 2};
+            int lo{pos >= 0 ? pos >> Q : -1};
+            int w{pos - lo * One};
+            ws[x] = {std::max(lo, 0), std::min(lo + 1, tiles - 1), w};
+        }
+        return ws;
+    }
+}  // namespace CLAHE
+
+// clipLimit is relative to the mean bin height of a tile; <= 0 disables clipping.
+inline cv::Mat adaptiveHistogramEqualization(const cv::Mat &image, int tilesX = 8, int tilesY = 8, double clipLimit = 4.0) {
+    using namespace CLAHE;
+    int m = image.rows, n = image.cols;
+    cv::Mat image_(m, n, CV_8UC1);
+    if (m == 0 || n == 0) return image_;
+
+    int tw{(n + tilesX - 1) / tilesX}, th{(m + tilesY - 1) / tilesY};
+    tilesX = (n + tw - 1) / tw;  // drop tiles that would be empty
+    tilesY = (m + th - 1) / th;
+
+    std::vector<Table> lut(static_cast<std::size_t>(tilesX) * tilesY);
+
+    cv::parallel_for_(cv::Range(0, tilesX * tilesY), [&](const cv::Range &range) {
+        for (int t = range.start; t < range.end; t++) {
+            int tx{t % tilesX}, ty{t / tilesX};
+            cv::Rect tile(tx * tw, ty * th, std::min(tw, n - tx * tw), std::min(th, m - ty * th));
+            std::uint64_t pixels{static_cast<std::uint64_t>(tile.area())};
+
+            Histogram::Bank bank[Histogram::Banks];
+            for (auto &b : bank) b.fill(0);
+            for (int i = tile.y; i < tile.y + tile.height; i++) {
+                Histogram::countRow(image.ptr<uchar>(i) + tile.x, tile.width, bank);
+            }
+
+            GrayscaleArray hist;
+            hist.fill(0);
+            for (auto &b : bank)
+                for (int v = 0; v < 256; v++) hist[v] += b[v];
+
+            if (clipLimit > 0)
+                clip(hist, std::max<std::uint64_t>(1, static_cast<std::uint64_t>(clipLimit * pixels / 256)));
+            lut[t] = equalize(hist, pixels);
+        }
+    });
+
+    std::vector<Weight> wx{weights(n, tw, tilesX)}, wy{weights(m, th, tilesY)};
+
+    cv::parallel_for_(cv::Range(0, m), [&](const cv::Range &range) {
+        for (int i = range.start; i < range.end; i++) {
+            const uchar *src{image.ptr<uchar>(i)};
+            uchar *dst{image_.ptr<uchar>(i)};
+            const Weight &y{wy[i]};
+            const Table *top{&lut[static_cast<std::size_t>(y.lo) * tilesX]}, *bottom{&lut[static_cast<std::size_t>(y.hi) * tilesX]};
+            for (int j = 0; j < n; j++) {
+                const Weight &x{wx[j]};
+                uchar v{src[j]};
+                std::int64_t a{top[x.lo][v] * (One - x.w) + top[x.hi][v] * x.w};
+                std::int64_t b{bottom[x.lo][v] * (One - x.w) + bottom[x.hi][v] * x.w};
+                dst[j] = static_cast<uchar>((a * (One - y.w) + b * y.w + (std::int64_t{1} << (2 * Q - 1))) >> (2 * Q));
+            }
+        }
+    });
+
+    return image_;
+}
+
+#endif
@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <opencv2/core.hpp>
+#include <random>
+#include <vector>
+
+#include "../utils.cpp"
+#include "CLAHE.h"
+
+// Straightforward CLAHE on the same tile grid: one tile at a time, the LUT
+// kept in floating point, and every pixel locating its four tile centres and
+// blending them in double precision. Serves as the timing baseline and as
+// the float reference the integer path is checked against.
+cv::Mat naiveCLAHE(const cv::Mat &image, int tilesX, int tilesY, double clipLimit) {
+    int m = image.rows, n = image.cols;
+    cv::Mat image_(m, n, CV_8UC1);
+    int tw{(n + tilesX - 1) / tilesX}, th{(m + tilesY - 1) / tilesY};
+    tilesX = (n + tw - 1) / tw;
+    tilesY = (m + th - 1) / th;
+
+    std::vector<std::vector<double>> lut(tilesX * tilesY, std::vector<double>(256));
+    for (int ty = 0; ty < tilesY; ty++) {
+        for (int tx = 0; tx < tilesX; tx++) {
+            int x0{tx * tw}, y0{ty * th}, x1{std::min(n, x0 + tw)}, y1{std::min(m, y0 + th)};
+            std::uint64_t pixels{static_cast<std::uint64_t>(x1 - x0) * (y1 - y0)};
+            GrayscaleArray hist;
+            hist.fill(0);
+            for (int i = y0; i < y1; i++)
+                for (int j = x0; j < x1; j++) hist[image.at<uchar>(i, j)]++;
+            if (clipLimit > 0)
+                CLAHE::clip(hist, std::max<std::uint64_t>(1, static_cast<std::uint64_t>(clipLimit * pixels / 256)));
+            std::uint64_t cdf = 0;
+            for (int v = 0; v < 256; v++) {
+                cdf += hist[v];
+                lut[ty * tilesX + tx][v] = std::min(255.0, 255.0 * cdf / pixels);
+            }
+        }
+    }
+
+    auto locate{[](int x, int t, int tiles, int &lo, int &hi, double &w) {
+        double pos{(x + 0.5) / t - 0.5};
+        int f{static_cast<int>(std::floor(pos))};
+        w = pos - f;
+        lo = std::max(f, 0);
+        hi = std::min(f + 1, tiles - 1);
+    }};
+
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < n; j++) {
+            int ylo, yhi, xlo, xhi;
+            double wy, wx;
+            locate(i, th, tilesY, ylo, yhi, wy);
+            locate(j, tw, tilesX, xlo, xhi, wx);
+            uchar v{image.at<uchar>(i, j)};
+            double a{lut[ylo * tilesX + xlo][v] * (1 - wx) + lut[ylo * tilesX + xhi][v] * wx};
+            double b{lut[yhi * tilesX + xlo][v] * (1 - wx) + lut[yhi * tilesX + xhi][v] * wx};
+            image_.at<uchar>(i, j) = static_cast<uchar>(std::lround(a * (1 - wy) + b * wy));
+        }
+    }
+
+    return image_;
+}
+
+int main() {
+    std::mt19937 rng{11533};
+
+    for (int size : {512, 2048, 4096}) {
+        // smooth gradient plus noise, so tiles get different LUTs
+        cv::Mat image(size, size, CV_8UC1);
+        std::uniform_int_distribution<int> noise(-20, 20);
+        for (int i = 0; i < size; i++) {
+            uchar *dst{image.ptr<uchar>(i)};
+            for (int j = 0; j < size; j++) {
+                dst[j] = static_cast<uchar>(std::clamp((i + 2 * j) * 100 / (3 * size) + 60 + noise(rng), 0, 255));
+            }
+        }
+
+        Timer t;
+        cv::Mat reference{naiveCLAHE(image, 8, 8, 4.0)};
+        double tNaive{t.elapsed()};
+
+        t.reset();
+        cv::Mat fast{adaptiveHistogramEqualization(image, 8, 8, 4.0)};
+        double tFast{t.elapsed()};
+
+        int maxError = 0;
+        for (int i = 0; i < size; i++) {
+            const uchar *a{reference.ptr<uchar>(i)}, *b{fast.ptr<uchar>(i)};
+            for (int j = 0; j < size; j++) maxError = std::max(maxError, std::abs(a[j] - b[j]));
+        }
+
+        std::cout << size << "x" << size << ": naive " << tNaive << "s, tiled " << tFast << "s, max error "
+                  << maxError << (maxError <= 1 ? "" : "  [MISMATCH]") << std::endl;
+    }
+
+    return 0;
+}
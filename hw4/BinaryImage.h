@@ -0,0 +1,285 @@
+#ifndef BINARYIMAGE_H
+#define BINARYIMAGE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <opencv2/core.hpp>
+#include <vector>
+
+#include "../StructuringElement.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Binary image packed 64 pixels per word: pixel j of a row is bit (j & 63) of
+// word (j >> 6), and the unused bits past the last column are always 0.
+// Morphology works on whole words: a structuring element offset becomes a
+// shifted copy of the rows, which is ORed (dilation) or ANDed (erosion) in.
+// Every operation takes a runtime offset list or, as a template argument, a
+// compile-time StructuringElement whose taps unroll.
+class BinaryImage {
+   public:
+    using Word = std::uint64_t;
+    using Kernel = std::vector<std::vector<int>>;  // {dy, dx} offsets
+
+    BinaryImage(int rows, int cols) : m{rows}, n{cols}, words{(cols + 63) / 64}, bits(static_cast<std::size_t>(rows) * words, 0) {}
+
+    // Non-zero pixels are foreground.
+    explicit BinaryImage(const cv::Mat &image) : BinaryImage(image.rows, image.cols) {
+        for (int i = 0; i < m; i++) {
+            const uchar *src{image.ptr<uchar>(i)};
+            Word *dst{row(i)};
+            int j = 0;
+#if defined(__SSE2__)
+            const __m128i zero{_mm_setzero_si128()};
+            for (; j + 16 <= n; j += 16) {
+                __m128i v{_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + j))};
+                Word mask{static_cast<Word>(~_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) & 0xFFFF)};
+                dst[j >> 6] |= mask << (j & 63);
+            }
+#endif
+            for (; j < n; j++) {
+                if (src[j]) dst[j >> 6] |= Word{1} << (j & 63);
+            }
+        }
+    }
+
+    // Foreground becomes 255, background 0.
+    cv::Mat toMat() const {
+        cv::Mat image_(m, n, CV_8UC1);
+        for (int i = 0; i < m; i++) {
+            const Word *src{row(i)};
+            uchar *dst{image_.ptr<uchar>(i)};
+            for (int j = 0; j < n; j++) {
+                dst[j] = ((src[j >> 6] >> (j & 63)) & 1) ? 0xFF : 0;
+            }
+        }
+        return image_;
+    }
+
+    int rows() const { return m; }
+    int cols() const { return n; }
+    Word *row(int i) { return &bits[static_cast<std::size_t>(i) * words]; }
+    const Word *row(int i) const { return &bits[static_cast<std::size_t>(i) * words]; }
+
+    bool at(int i, int j) const { return (row(i)[j >> 6] >> (j & 63)) & 1; }
+
+    BinaryImage complement() const {
+        BinaryImage r(m, n);
+        for (std::size_t w = 0; w < bits.size(); w++) r.bits[w] = ~bits[w];
+        r.clearPadding();
+        return r;
+    }
+
+    BinaryImage intersect(const BinaryImage &o) const {
+        CV_Assert(m == o.m && n == o.n);
+        BinaryImage r(m, n);
+        for (std::size_t w = 0; w < bits.size(); w++) r.bits[w] = bits[w] & o.bits[w];
+        return r;
+    }
+
+    BinaryImage unite(const BinaryImage &o) const {
+        CV_Assert(m == o.m && n == o.n);
+        BinaryImage r(m, n);
+        for (std::size_t w = 0; w < bits.size(); w++) r.bits[w] = bits[w] | o.bits[w];
+        return r;
+    }
+
+    // out(y, x) = OR over offsets p of in(y - p.dy, x - p.dx); outside pixels are 0.
+    BinaryImage dilate(const Kernel &k) const {
+        return filter(RuntimeTaps{k}, true);
+    }
+
+    template <class SE>
+    BinaryImage dilate() const {
+        return filter(FixedTaps<SE>{}, true);
+    }
+
+    // out(y, x) = AND over offsets p of in(y + p.dy, x + p.dx); offsets that
+    // fall outside the image are ignored, as in the byte-per-pixel erosion.
+    BinaryImage erode(const Kernel &k) const {
+        return filter(RuntimeTaps{k}, false);
+    }
+
+    template <class SE>
+    BinaryImage erode() const {
+        return filter(FixedTaps<SE>{}, false);
+    }
+
+    // Erosion then dilation (and the reverse for close) fused row by row: the
+    // intermediate image only exists as a ring of kernel-height packed rows.
+    BinaryImage open(const Kernel &k) const {
+        return chain(RuntimeTaps{k}, false, true);
+    }
+
+    template <class SE>
+    BinaryImage open() const {
+        return chain(FixedTaps<SE>{}, false, true);
+    }
+
+    BinaryImage close(const Kernel &k) const {
+        return chain(RuntimeTaps{k}, true, false);
+    }
+
+    template <class SE>
+    BinaryImage close() const {
+        return chain(FixedTaps<SE>{}, true, false);
+    }
+
+    // erode(j) intersected with complement().erode(k) in one pass: offsets in
+    // j must be foreground and offsets in k background, and offsets outside
+    // the image are ignored for both.
+    BinaryImage hitAndMiss(const Kernel &j, const Kernel &k) const {
+        return hitAndMiss(RuntimeTaps{j}, RuntimeTaps{k});
+    }
+
+    template <class J, class K>
+    BinaryImage hitAndMiss() const {
+        return hitAndMiss(FixedTaps<J>{}, FixedTaps<K>{});
+    }
+
+   private:
+    // Tap sets: forEach(f) calls f(dy, dx) for every offset, and top/bottom
+    // bound dy.
+    struct RuntimeTaps {
+        explicit RuntimeTaps(const Kernel &k) : k{k} {
+            for (auto &p : k) top = std::min(top, p[0]), bottom = std::max(bottom, p[0]);
+        }
+
+        template <class F>
+        void forEach(F f) const {
+            for (auto &p : k) f(p[0], p[1]);
+        }
+
+        const Kernel &k;
+        int top{0}, bottom{0};
+    };
+
+    template <class SE>
+    struct FixedTaps {
+        template <class F>
+        void forEach(F f) const {
+            SE::forEach([&](const Offset &o) { f(o.dy, o.dx); });
+        }
+
+        static constexpr int top{std::min(0, SE::top)}, bottom{std::max(0, SE::bottom)};
+    };
+
+    template <class J, class K>
+    BinaryImage hitAndMiss(const J &j, const K &k) const {
+        BinaryImage r(m, n);
+        std::vector<Word> line(words);
+        for (int i = 0; i < m; i++) {
+            Word *dst{r.row(i)};
+            std::fill(dst, dst + words, ~Word{0});
+            j.forEach([&](int dy, int dx) {
+                int y{i + dy};
+                shiftedRow(y >= 0 && y < m ? row(y) : nullptr, dx, true, line.data());
+                for (int w = 0; w < words; w++) dst[w] &= line[w];
+            });
+            k.forEach([&](int dy, int dx) {
+                int y{i + dy};
+                shiftedRow(y >= 0 && y < m ? row(y) : nullptr, dx, false, line.data());
+                for (int w = 0; w < words; w++) dst[w] &= ~line[w];
+            });
+        }
+        r.clearPadding();
+        return r;
+    }
+
+    template <class Set>
+    BinaryImage filter(const Set &k, bool dilate) const {
+        BinaryImage r(m, n);
+        std::vector<Word> line(words);
+        auto src{[&](int y) { return row(y); }};
+        for (int i = 0; i < m; i++) filterRow(src, i, k, dilate, r.row(i), line.data());
+        return r;
+    }
+
+    // The same taps twice, dilating first if dilate1.
+    template <class Set>
+    BinaryImage chain(const Set &k, bool dilate1, bool dilate2) const {
+        int top{k.top}, bottom{k.bottom};
+        // newest first-stage row that output row i reads
+        int ahead{dilate2 ? -top : bottom}, span{bottom - top + 1};
+
+        BinaryImage r(m, n);
+        std::vector<Word> ring(static_cast<std::size_t>(span) * words), line(words);
+        auto src{[&](int y) { return row(y); }};
+        auto mid{[&](int y) { return &ring[static_cast<std::size_t>(y % span) * words]; }};
+        int done = 0;
+        for (int i = 0; i < m; i++) {
+            for (; done < m && done <= i + ahead; done++) filterRow(src, done, k, dilate1, mid(done), line.data());
+            filterRow(mid, i, k, dilate2, r.row(i), line.data());
+        }
+        return r;
+    }
+
+    // Row i of the dilation/erosion of the image whose row y is rows(y).
+    template <class Rows, class Set>
+    void filterRow(Rows rows, int i, const Set &k, bool dilate, Word *dst, Word *line) const {
+        std::fill(dst, dst + words, dilate ? Word{0} : ~Word{0});
+        k.forEach([&](int dy, int dx) {
+            int y{dilate ? i - dy : i + dy};
+            shiftedRow(y >= 0 && y < m ? rows(y) : nullptr, dilate ? -dx : dx, !dilate, line);
+            if (dilate) {
+                for (int w = 0; w < words; w++) dst[w] |= line[w];
+            } else {
+                for (int w = 0; w < words; w++) dst[w] &= line[w];
+            }
+        });
+        int tail{n & 63};
+        if (tail) dst[words - 1] &= (Word{1} << tail) - 1;
+    }
+
+    // Writes src shifted so that out bit x = src bit x + dx; pixels outside
+    // the image (or every pixel, for a null src) read as fill.
+    void shiftedRow(const Word *src, int dx, bool fill, Word *out) const {
+        const Word ones{~Word{0}}, pad{fill ? ones : 0};
+        if (src == nullptr) {
+            std::fill(out, out + words, pad);
+            return;
+        }
+
+        int tail{n & 63};
+        // source word w as seen with out-of-image bits replaced by fill
+        auto word{[&](long long w) -> Word {
+            if (w < 0 || w >= words) return pad;
+            if (w == words - 1 && tail && fill) return src[w] | (ones << tail);
+            return src[w];
+        }};
+
+        long long q{dx >= 0 ? dx / 64 : -((-dx + 63) / 64)};
+        int r{dx - static_cast<int>(q) * 64};  // 0 <= r < 64
+        auto shifted{[&](int w) {
+            Word lo{word(w + q)};
+            out[w] = r ? (lo >> r) | (word(w + q + 1) << (64 - r)) : lo;
+        }};
+
+        // words [a, b) read only whole source words inside the row, and no
+        // padded last word, so they shift without checks
+        long long last{tail && fill ? words - 2 : words - 1};
+        int a{static_cast<int>(std::min<long long>(words, std::max<long long>(0, -q)))};
+        int b{static_cast<int>(std::max<long long>(a, std::min<long long>(words, last - q - (r ? 1 : 0) + 1)))};
+        for (int w = 0; w < a; w++) shifted(w);
+        if (r) {
+            for (int w = a; w < b; w++) out[w] = (src[w + q] >> r) | (src[w + q + 1] << (64 - r));
+        } else {
+            for (int w = a; w < b; w++) out[w] = src[w + q];
+        }
+        for (int w = b; w < words; w++) shifted(w);
+    }
+
+    void clearPadding() {
+        int tail{n & 63};
+        if (!tail) return;
+        Word keep{(Word{1} << tail) - 1};
+        for (int i = 0; i < m; i++) row(i)[words - 1] &= keep;
+    }
+
+    int m, n, words;
+    std::vector<Word> bits;
+};
+
+#endif
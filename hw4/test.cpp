@@ -0,0 +1,195 @@
+#include <cmath>
+#include <iostream>
+#include <opencv2/core.hpp>
+#include <random>
+
+#include "../DistanceTransform.h"
+#include "../StructuringElement.h"
+#include "BinaryImage.h"
+
+// Checks the packed morphology, with compile-time elements and with runtime
+// offset lists, against a per-pixel reference on widths around the 64-bit
+// word boundaries, and the distance-transform disk morphology against the
+// packed morphology by diskKernel.
+
+constexpr Taps<3> JTaps{{{0, -1}, {0, 0}, {1, 0}}};
+constexpr Taps<3> KTaps{{{-1, 0}, {-1, 1}, {0, 1}}};
+using J = StructuringElement<JTaps>;
+using K = StructuringElement<KTaps>;
+
+// reaches past a whole word on both sides, so rows shift by more than 64 bits
+constexpr Taps<4> Wide{{{-1, -70}, {0, 0}, {0, 65}, {2, 3}}};
+using WideSE = StructuringElement<Wide>;
+
+using Kernel = BinaryImage::Kernel;
+
+cv::Mat reference(const cv::Mat &image, const Kernel &k, bool dilate) {
+    int m = image.rows, n = image.cols;
+    cv::Mat image_(m, n, CV_8UC1);
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < n; j++) {
+            bool v{!dilate};
+            for (auto &p : k) {
+                int y{dilate ? i - p[0] : i + p[0]}, x{dilate ? j - p[1] : j + p[1]};
+                if (y < 0 || x < 0 || y >= m || x >= n) continue;
+                bool a{image.at<uchar>(y, x) != 0};
+                v = dilate ? v || a : v && a;
+            }
+            image_.at<uchar>(i, j) = v ? 255 : 0;
+        }
+    }
+    return image_;
+}
+
+cv::Mat reference(const cv::Mat &image, const Kernel &j, const Kernel &k) {
+    int m = image.rows, n = image.cols;
+    cv::Mat image_(m, n, CV_8UC1);
+    for (int y = 0; y < m; y++) {
+        for (int x = 0; x < n; x++) {
+            bool v{true};
+            for (int pass = 0; pass < 2; pass++) {
+                for (auto &p : pass ? k : j) {
+                    int i{y + p[0]}, l{x + p[1]};
+                    if (i < 0 || l < 0 || i >= m || l >= n) continue;
+                    v = v && (image.at<uchar>(i, l) != 0) == !pass;
+                }
+            }
+            image_.at<uchar>(y, x) = v ? 255 : 0;
+        }
+    }
+    return image_;
+}
+
+bool same(const cv::Mat &a, const cv::Mat &b) {
+    if (a.size() != b.size()) return false;
+    for (int i = 0; i < a.rows; i++)
+        for (int j = 0; j < a.cols; j++)
+            if (a.at<uchar>(i, j) != b.at<uchar>(i, j)) return false;
+    return true;
+}
+
+int expect(const BinaryImage &got, const cv::Mat &want, const char *what, const char *name) {
+    if (same(got.toMat(), want)) return 0;
+    std::cout << "[FAIL] " << what << ' ' << name << ' ' << want.size() << '\n';
+    return 1;
+}
+
+template <class SE>
+int check(const cv::Mat &image, const char *name) {
+    const BinaryImage bin{image};
+    const Kernel k{SE::kernel()};
+    cv::Mat d{reference(image, k, true)}, e{reference(image, k, false)};
+    cv::Mat o{reference(e, k, true)}, c{reference(d, k, false)};
+
+    int failures = 0;
+    failures += expect(bin.dilate<SE>(), d, "dilate", name);
+    failures += expect(bin.dilate(k), d, "dilate kernel", name);
+    failures += expect(bin.erode<SE>(), e, "erode", name);
+    failures += expect(bin.erode(k), e, "erode kernel", name);
+    failures += expect(bin.open<SE>(), o, "open", name);
+    failures += expect(bin.open(k), o, "open kernel", name);
+    failures += expect(bin.close<SE>(), c, "close", name);
+    failures += expect(bin.close(k), c, "close kernel", name);
+    return failures;
+}
+
+// diskErosion/diskDilation against BinaryImage by diskKernel(radius)
+int disk(const cv::Mat &image, int radius, const char *name) {
+    const BinaryImage bin{image};
+    const Kernel k{diskKernel(radius)};
+    int failures = 0;
+    if (!same(diskErosion(image, radius), bin.erode(k).toMat())) {
+        std::cout << "[FAIL] diskErosion " << name << " r=" << radius << ' ' << image.size() << '\n';
+        failures++;
+    }
+    if (!same(diskDilation(image, radius), bin.dilate(k).toMat())) {
+        std::cout << "[FAIL] diskDilation " << name << " r=" << radius << ' ' << image.size() << '\n';
+        failures++;
+    }
+    return failures;
+}
+
+// distanceMap against the nearest background pixel found by brute force
+int distances(const cv::Mat &image, const char *name) {
+    int m = image.rows, n = image.cols;
+    cv::Mat d{distanceMap(image)};
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < n; j++) {
+            float want{image.at<uchar>(i, j) ? INFINITY : 0.0f};
+            for (int y = 0; y < m; y++)
+                for (int x = 0; x < n; x++)
+                    if (!image.at<uchar>(y, x)) want = std::min(want, std::sqrt(static_cast<float>((y - i) * (y - i) + (x - j) * (x - j))));
+            if (d.at<float>(i, j) != want) {
+                std::cout << "[FAIL] distanceMap " << name << ' ' << image.size() << '\n';
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// radii past 46340 square to INT_MAX or more, the value marking no feature
+int hugeDisk(const cv::Mat &image, const char *name) {
+    int failures = 0;
+    bool any = false, all = true;
+    for (int i = 0; i < image.rows; i++)
+        for (int j = 0; j < image.cols; j++) any = any || image.at<uchar>(i, j), all = all && image.at<uchar>(i, j);
+    for (int radius : {46341, INT_MAX}) {
+        cv::Mat e{diskErosion(image, radius)}, d{diskDilation(image, radius)};
+        for (int i = 0; i < image.rows; i++) {
+            for (int j = 0; j < image.cols; j++) {
+                if ((e.at<uchar>(i, j) != 0) != all || (d.at<uchar>(i, j) != 0) != any) {
+                    std::cout << "[FAIL] disk " << name << " r=" << radius << ' ' << image.size() << '\n';
+                    failures++;
+                    i = image.rows;
+                    break;
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+int main() {
+    std::mt19937 rng(4);
+    std::bernoulli_distribution foreground(0.6);
+
+    const int sizes[][2]{{1, 1}, {1, 64}, {7, 1}, {5, 63}, {5, 64}, {5, 65}, {9, 130}, {17, 200}, {40, 40}};
+
+    int failures = 0;
+    for (auto &s : sizes) {
+        cv::Mat image(s[0], s[1], CV_8UC1);
+        for (int i = 0; i < image.rows; i++)
+            for (int j = 0; j < image.cols; j++) image.at<uchar>(i, j) = foreground(rng) ? 255 : 0;
+
+        failures += check<OctagonSE>(image, "octagon");
+        failures += check<WideSE>(image, "wide");
+
+        const BinaryImage bin{image};
+        cv::Mat h{reference(image, J::kernel(), K::kernel())};
+        failures += expect(bin.hitAndMiss<J, K>(), h, "hit-and-miss", "J K");
+        failures += expect(bin.hitAndMiss(J::kernel(), K::kernel()), h, "hit-and-miss kernel", "J K");
+    }
+
+    // r = 0 is the identity, and radii past the image reach every pixel
+    const int disks[][2]{{1, 1}, {1, 70}, {6, 1}, {9, 13}, {23, 66}};
+    for (auto &s : disks) {
+        cv::Mat image(s[0], s[1], CV_8UC1), empty(s[0], s[1], CV_8UC1, cv::Scalar(0)), full(s[0], s[1], CV_8UC1, cv::Scalar(255));
+        for (int i = 0; i < image.rows; i++)
+            for (int j = 0; j < image.cols; j++) image.at<uchar>(i, j) = foreground(rng) ? 255 : 0;
+
+        for (int radius : {0, 1, 2, 3, 5, s[0] + s[1]}) {
+            failures += disk(image, radius, "random");
+            failures += disk(empty, radius, "empty");
+            failures += disk(full, radius, "full");
+        }
+        failures += distances(image, "random");
+        failures += distances(full, "full");
+        failures += hugeDisk(image, "random");
+        failures += hugeDisk(empty, "empty");
+        failures += hugeDisk(full, "full");
+    }
+
+    std::cout << (failures ? "FAILED" : "passed") << '\n';
+    return failures ? 1 : 0;
+}
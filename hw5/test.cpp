@@ -0,0 +1,98 @@
+#include <iostream>
+#include <opencv2/core.hpp>
+#include <random>
+
+#include "../Morphology.h"
+
+// Checks the compile-time filters and the fused gradient against a per-tap
+// reference, including images narrower or shorter than the kernel.
+
+// an asymmetric shape, so mirrored offsets would show
+constexpr Taps<5> Skewed{{{-1, 0}, {0, 0}, {0, 2}, {1, -1}, {2, 1}}};
+using SkewedSE = StructuringElement<Skewed>;
+
+// nothing below the origin, so the last row is interior and a column range
+// past a narrow image would write outside the result
+constexpr Taps<3> Leftward{{{-1, 0}, {0, -2}, {0, 0}}};
+using LeftwardSE = StructuringElement<Leftward>;
+
+cv::Mat reference(const cv::Mat &image, const Morphology::Kernel &k, bool dilate) {
+    int m = image.rows, n = image.cols;
+    cv::Mat image_(m, n, CV_8UC1);
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < n; j++) {
+            int v{dilate ? 0 : 255};
+            for (auto &p : k) {
+                int y{i + p[0]}, x{j + p[1]};
+                if (y < 0 || x < 0 || y >= m || x >= n) continue;
+                int a{image.at<uchar>(y, x)};
+                v = dilate ? std::max(v, a) : std::min(v, a);
+            }
+            image_.at<uchar>(i, j) = static_cast<uchar>(v);
+        }
+    }
+    return image_;
+}
+
+bool same(const cv::Mat &a, const cv::Mat &b) {
+    if (a.size() != b.size()) return false;
+    for (int i = 0; i < a.rows; i++)
+        for (int j = 0; j < a.cols; j++)
+            if (a.at<uchar>(i, j) != b.at<uchar>(i, j)) return false;
+    return true;
+}
+
+template <class SE>
+int check(const cv::Mat &image, const char *name) {
+    int failures = 0;
+    Morphology::Kernel k{SE::kernel()};
+    if (!same(Morphology::dilate<SE>(image), reference(image, k, true))) {
+        std::cout << "[FAIL] dilate " << name << ' ' << image.size() << '\n';
+        failures++;
+    }
+    if (!same(Morphology::erode<SE>(image), reference(image, k, false))) {
+        std::cout << "[FAIL] erode " << name << ' ' << image.size() << '\n';
+        failures++;
+    }
+    return failures;
+}
+
+int gradient(const cv::Mat &image, const Morphology::Kernel &k, const char *name) {
+    cv::Mat d{reference(image, k, true)}, e{reference(image, k, false)}, g(image.rows, image.cols, CV_8UC1);
+    for (int i = 0; i < image.rows; i++)
+        for (int j = 0; j < image.cols; j++)
+            g.at<uchar>(i, j) = static_cast<uchar>(d.at<uchar>(i, j) - e.at<uchar>(i, j));
+    if (same(Morphology::gradient(image, k), g)) return 0;
+    std::cout << "[FAIL] gradient " << name << ' ' << image.size() << '\n';
+    return 1;
+}
+
+int main() {
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> value(0, 255);
+
+    // widths 1 and 2 are narrower than the octagon's left reach
+    const int sizes[][2]{{1, 1}, {1, 7}, {7, 1}, {7, 2}, {2, 7}, {3, 3}, {4, 5}, {5, 4}, {17, 33}, {64, 61}};
+    // beyond 5x5, so the gradient runs on decomposed boxes
+    Morphology::Kernel disc;
+    for (int dy = -4; dy <= 4; dy++)
+        for (int dx = -4; dx <= 4; dx++)
+            if (dy * dy + dx * dx <= 16) disc.push_back({dy, dx});
+
+    int failures = 0;
+    for (auto &s : sizes) {
+        cv::Mat image(s[0], s[1], CV_8UC1);
+        for (int i = 0; i < image.rows; i++)
+            for (int j = 0; j < image.cols; j++)
+                image.at<uchar>(i, j) = static_cast<uchar>(value(rng));
+
+        failures += check<OctagonSE>(image, "octagon");
+        failures += check<SkewedSE>(image, "skewed");
+        failures += check<LeftwardSE>(image, "leftward");
+        failures += gradient(image, OctagonSE::kernel(), "octagon");
+        failures += gradient(image, disc, "disc");
+    }
+
+    std::cout << (failures ? "FAILED" : "passed") << '\n';
+    return failures ? 1 : 0;
+}
@@ -3,21 +3,13 @@
 #include <opencv2/imgcodecs.hpp>
 #include <vector>
 
+#include "../Neighborhood.h"
+#include "../PointOp.h"
+
 const cv::String lena{"../lena.bmp"};
 
 cv::Mat binarize(const cv::Mat &image, int threshold) {
-    int m = image.rows, n = image.cols;
-    cv::Mat image_(m, n, CV_8UC1, cv::Scalar::all(0));
-
-    for (int i = 0; i < m; i++) {
-        const uchar *src{image.ptr<uchar>(i)};
-        uchar *dst{image_.ptr<uchar>(i)};
-        for (int j = 0; j < n; j++) {
-            dst[j] = (src[j] >= threshold) ? 255 : 0;
-        }
-    }
-
-    return image_;
+    return PointOp::threshold(threshold).apply(image);
 }
 
 cv::Mat downsample(const cv::Mat &image) {
@@ -50,55 +42,15 @@ int f(const std::vector<char> &a) {
     return (r_count == 4) ? 5 : q_count;
 }
 
-std::vector<char> neighbor(const cv::Mat &image, int row, int col) {
-    int m = image.rows, n = image.cols;
-    std::vector<std::vector<std::vector<int>>> dirs{
-        {{0, 0}, {0, 1}, {-1, 1}, {-1, 0}},    // a1
-        {{0, 0}, {-1, 0}, {-1, -1}, {0, -1}},  // a2
-        {{0, 0}, {0, -1}, {1, -1}, {1, 0}},    // a3
-        {{0, 0}, {1, 0}, {1, 1}, {0, 1}}};     // a4
-    std::vector<char> a;
-
-    for (auto &dir : dirs) {
-        char c = h(image.at<uchar>(row + dir[0][0], col + dir[0][1]),
-                   image.at<uchar>(row + dir[1][0], col + dir[1][1]),
-                   image.at<uchar>(row + dir[2][0], col + dir[2][1]),
-                   image.at<uchar>(row + dir[3][0], col + dir[3][1]));
-        a.push_back(c);
-    }
-
-    return a;
-}
-
-cv::Mat padding(const cv::Mat &image) {
-    int m = image.rows, n = image.cols;
-    cv::Mat image_(m + 2, n + 2, CV_8UC1, cv::Scalar::all(128));
-
-    for (int i = 0; i < m; i++) {
-        const uchar *src{image.ptr<uchar>(i)};
-        uchar *dst{image_.ptr<uchar>(i + 1)};
-        for (int j = 0; j < n; j++) {
-            dst[j + 1] = src[j];
-        }
-    }
-
-    return image_;
-}
-
-std::vector<std::vector<int>> Yokoi(const cv::Mat &image) {
-    int m = image.rows, n = image.cols;
-    std::vector<std::vector<int>> label(m, std::vector<int>(n, 0));
-    cv::Mat image_{padding(image)};
-
-    for (int i = 0; i < m; i++) {
-        const uchar *src{image_.ptr<uchar>(i + 1)};
-        for (int j = 0; j < n; j++) {
-            if (src[j + 1] != 0)
-                label[i][j] = f(neighbor(image_, i + 1, j + 1));
-        }
-    }
+// Yokoi number of the centre pixel, 0 for background
+const Neighborhood::Table yokoiTable{Neighborhood::compile([](int code) {
+    return Neighborhood::x(code, 0) ? f(Neighborhood::quadrants(code, h)) : 0;
+})};
 
-    return label;
+// Yokoi numbers (CV_8UC1, 0 on background) of an image of any size, in
+// parallel row bands.
+cv::Mat Yokoi(const cv::Mat &image) {
+    return Neighborhood::apply(image, yokoiTable, cv::getNumThreads());
 }
 
 int main() {
@@ -108,14 +60,15 @@ int main() {
     M = binarize(image, 128);
     M = downsample(M);
 
-    auto label{Yokoi(M)};
+    cv::Mat label{Yokoi(M)};
 
-    for (auto &r : label) {
-        for (auto &v : r) {
-            if (v == 0)
+    for (int i = 0; i < label.rows; i++) {
+        const uchar *src{label.ptr<uchar>(i)};
+        for (int j = 0; j < label.cols; j++) {
+            if (src[j] == 0)
                 std::cout << std::setw(2) << ' ';
             else
-                std::cout << std::setw(2) << v;
+                std::cout << std::setw(2) << static_cast<int>(src[j]);
         }
         std::cout << std::endl;
     }
@@ -0,0 +1,442 @@
+#ifndef THINNING_H
+#define THINNING_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <opencv2/core.hpp>
+#include <queue>
+#include <vector>
+
+#include "../DistanceTransform.h"
+#include "../Neighborhood.h"
+
+// Worklist form of the Yokoi / pair relation / connected shrink thinning.
+// Each iteration of the original labels every pixel with its Yokoi number,
+// marks 'p' the pixels labelled 1 that have a 4-neighbour labelled 1, and
+// then sweeps the image in raster order deleting the 'p' pixels the shrink
+// rule allows, every deletion being visible to the pixels after it.
+//
+// A label depends on the 3x3 window and a mark on the labels of the pixel
+// and its 4-neighbours. After a sweep only labels within one pixel of a
+// deletion, and the marks next to those, can change; only those pixels can
+// decide differently in the next sweep, and within a sweep only the later
+// neighbours of a pixel just deleted can. Those go on a raster-ordered
+// worklist and every other pixel keeps its state, so after the first pass
+// the work follows the removed pixels instead of the image size.
+namespace Thinning {
+    using Worklist = std::priority_queue<int, std::vector<int>, std::greater<int>>;
+
+    // 'p' marks (1) of a label image: label 1 with a 4-neighbour labelled 1
+    inline cv::Mat marks(const cv::Mat &label, int bands) {
+        int m = label.rows, n = label.cols;
+        cv::Mat mark(m, n, CV_8UC1);
+
+        cv::parallel_for_(cv::Range(0, m), [&](const cv::Range &range) {
+            for (int i = range.start; i < range.end; i++) {
+                const uchar *up{i > 0 ? label.ptr<uchar>(i - 1) : nullptr};
+                const uchar *mid{label.ptr<uchar>(i)};
+                const uchar *down{i + 1 < m ? label.ptr<uchar>(i + 1) : nullptr};
+                uchar *dst{mark.ptr<uchar>(i)};
+                for (int j = 0; j < n; j++) {
+                    dst[j] = mid[j] == 1 && ((up && up[j] == 1) || (down && down[j] == 1) ||
+                                             (j > 0 && mid[j - 1] == 1) || (j + 1 < n && mid[j + 1] == 1));
+                }
+            }
+        }, bands);
+
+        return mark;
+    }
+
+    // Indices (i * n + j) of the foreground pixels by ascending d2, raster
+    // order among equals: a stable two-pass radix sort on 16-bit digits.
+    inline std::vector<int> byDistance(const std::vector<int> &d2, const std::vector<int> &foreground) {
+        std::vector<int> order{foreground}, tmp(order.size());
+        for (int shift = 0; shift < 32; shift += 16) {
+            std::vector<int> count(1 << 16 | 1, 0);
+            for (int k : order) count[((static_cast<unsigned>(d2[k]) >> shift) & 0xFFFF) + 1]++;
+            for (int b = 0; b < 1 << 16; b++) count[b + 1] += count[b];
+            for (int k : order) tmp[count[(static_cast<unsigned>(d2[k]) >> shift) & 0xFFFF]++] = k;
+            order.swap(tmp);
+        }
+        return order;
+    }
+}  // namespace Thinning
+
+// yokoi gives the Yokoi number of a window code, shrink 0 where the centre
+// may be removed (see Neighborhood::compile).
+inline cv::Mat incrementalThinning(const cv::Mat &image, const Neighborhood::Table &yokoi, const Neighborhood::Table &shrink) {
+    int m = image.rows, n = image.cols;
+    cv::Mat image_{image.clone()};
+    if (m == 0 || n == 0) return image_;
+
+    std::size_t N{static_cast<std::size_t>(m) * n};
+    std::vector<uchar> label(N), mark(N);
+    // sweep number in which a pixel was last queued, relabelled or remarked
+    std::vector<int> queued(N, -1), relabelled(N, -1), remarked(N, -1);
+
+    cv::Mat L{Neighborhood::apply(image_, yokoi)};
+    for (int i = 0; i < m; i++) {
+        const uchar *src{L.ptr<uchar>(i)};
+        std::copy(src, src + n, &label[static_cast<std::size_t>(i) * n]);
+    }
+
+    auto markAt{[&](int i, int j) -> uchar {
+        int k{i * n + j};
+        if (label[k] != 1) return 0;
+        return (i > 0 && label[k - n] == 1) || (i + 1 < m && label[k + n] == 1) ||
+               (j > 0 && label[k - 1] == 1) || (j + 1 < n && label[k + 1] == 1);
+    }};
+
+    std::vector<int> work, deleted, changed;
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < n; j++) {
+            mark[i * n + j] = markAt(i, j);
+            if (mark[i * n + j]) work.push_back(i * n + j);
+        }
+    }
+
+    for (int sweep = 0;; sweep++) {
+        Thinning::Worklist queue;
+        for (int k : work) {
+            queued[k] = sweep;
+            queue.push(k);
+        }
+
+        deleted.clear();
+        while (!queue.empty()) {
+            int k{queue.top()};
+            queue.pop();
+            int i{k / n}, j{k % n};
+            uchar *p{image_.ptr<uchar>(i) + j};
+            if (!mark[k] || *p == 0 || shrink[Neighborhood::code(image_, i, j)] != 0) continue;
+
+            *p = 0;
+            deleted.push_back(k);
+            // neighbours after (i, j) in raster order see the deletion this sweep
+            for (int dy = 0; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    int y{i + dy}, x{j + dx};
+                    if ((dy == 0 && dx <= 0) || y >= m || x < 0 || x >= n) continue;
+                    int q{y * n + x};
+                    if (queued[q] != sweep) {
+                        queued[q] = sweep;
+                        queue.push(q);
+                    }
+                }
+            }
+        }
+
+        if (deleted.empty()) break;
+
+        changed.clear();
+        for (int k : deleted) {
+            int i{k / n}, j{k % n};
+            for (int y = std::max(0, i - 1); y <= std::min(m - 1, i + 1); y++) {
+                for (int x = std::max(0, j - 1); x <= std::min(n - 1, j + 1); x++) {
+                    int q{y * n + x};
+                    if (relabelled[q] == sweep) continue;
+                    relabelled[q] = sweep;
+                    label[q] = yokoi[Neighborhood::code(image_, y, x)];
+                    changed.push_back(q);
+                }
+            }
+        }
+
+        work.clear();
+        for (int k : changed) {
+            int i{k / n}, j{k % n};
+            const int dirs[5][2]{{0, 0}, {-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+            for (auto &d : dirs) {
+                int y{i + d[0]}, x{j + d[1]};
+                if (y < 0 || x < 0 || y >= m || x >= n) continue;
+                int q{y * n + x};
+                if (remarked[q] == sweep) continue;
+                remarked[q] = sweep;
+                mark[q] = markAt(y, x);
+                if (mark[q]) work.push_back(q);
+            }
+        }
+    }
+
+    return image_;
+}
+
+// Parallel variant with the same label, mark and shrink rules. The sweep
+// of each iteration is split into four subfields by row and column parity.
+// Pixels of one subfield are never 8-adjacent, so none of them lies in
+// another's 3x3 window: within a subfield every decision is independent of
+// the others, the subfield's rows are shrunk in parallel, and the skeleton
+// is the same for any number of threads. It is a different (equally thin)
+// skeleton from the raster-order one, whose deletions chain along rows.
+//
+// Once a sweep deletes less than 1/Sparse of the image, the frontier of
+// incrementalThinning takes over: only the labels within one pixel of the
+// sweep's deletions and the marks next to those are recomputed, and only
+// those pixels are queued for the next sweep, whose subfields also queue
+// the 8-neighbours of their deletions in the later subfields. Every other
+// pixel would decide as it did before. Each band tests, queues, relabels
+// and remarks the pixels of its own rows. Sweeps that delete more redo the
+// labels and marks in full and test every pixel, which is cheaper there.
+//
+// This is the entry point for large images: call it with the yokoi and
+// shrink tables of Yokoi.h and cv::getNumThreads() bands, as bench.cpp does.
+inline cv::Mat subfieldThinning(const cv::Mat &image, const Neighborhood::Table &yokoi, const Neighborhood::Table &shrink, int bands) {
+    constexpr std::size_t Sparse{32};
+    int m = image.rows, n = image.cols;
+    cv::Mat image_{image.clone()};
+    if (m == 0 || n == 0) return image_;
+    // every band owns a row at least, so the pixels a deletion or a new
+    // label touches lie in its own band or the next one on either side
+    bands = std::max(1, std::min(bands, m));
+
+    cv::Mat label{Neighborhood::apply(image_, yokoi, bands)};
+    cv::Mat mark{Thinning::marks(label, bands)};
+
+    std::size_t N{static_cast<std::size_t>(m) * n};
+    // set while a pixel is in a band's changed or remarks list, or in its
+    // subfield's work list
+    std::vector<uchar> relabelled(N, 0), remarked(N, 0), listed(N, 0);
+    // work[f * bands + b]: pixels of subfield f in band b still to be tested;
+    // deleted[b]: the sweep's deletions in band b, the current subfield's
+    // from fresh[b] on
+    std::vector<std::vector<int>> work(4 * static_cast<std::size_t>(bands)), deleted(bands), changed(bands), remarks(bands);
+    std::vector<std::size_t> fresh(bands);
+
+    auto first{[&](int b) { return static_cast<int>(static_cast<long long>(m) * b / bands); }};
+    auto field{[](int i, int j) { return (i & 1) << 1 | (j & 1); }};
+    auto markAt{[&](int i, int j) -> uchar {
+        const uchar *mid{label.ptr<uchar>(i)};
+        if (mid[j] != 1) return 0;
+        return (i > 0 && label.ptr<uchar>(i - 1)[j] == 1) || (i + 1 < m && label.ptr<uchar>(i + 1)[j] == 1) ||
+               (j > 0 && mid[j - 1] == 1) || (j + 1 < n && mid[j + 1] == 1);
+    }};
+    auto enlist{[&](int b, int i, int j) {
+        int k{i * n + j};
+        if (listed[k] || !mark.ptr<uchar>(i)[j] || !image_.ptr<uchar>(i)[j]) return;
+        listed[k] = 1;
+        work[static_cast<std::size_t>(field(i, j)) * bands + b].push_back(k);
+    }};
+    // f(b, r0, r1) for every band b, rows r0 .. r1 - 1, in parallel
+    auto perBand{[&](auto f) {
+        cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range &range) {
+            for (int b = range.start; b < range.end; b++) f(b, first(b), first(b + 1));
+        });
+    }};
+    // g(y, x) for the pixels of rows r0 .. r1 - 1 in the 3x3 window of a
+    // pixel deleted in band b or next to it, from position from(c) of deleted[c]
+    auto around{[&](int b, int r0, int r1, auto from, auto g) {
+        for (int c = std::max(0, b - 1); c <= std::min(bands - 1, b + 1); c++) {
+            for (std::size_t d = from(c); d < deleted[c].size(); d++) {
+                int i{deleted[c][d] / n}, j{deleted[c][d] % n};
+                for (int y = std::max(r0, i - 1); y <= std::min(r1 - 1, i + 1); y++)
+                    for (int x = std::max(0, j - 1); x <= std::min(n - 1, j + 1); x++) g(y, x);
+            }
+        }
+    }};
+
+    for (bool dense = true;;) {
+        for (auto &d : deleted) d.clear();
+
+        for (int f = 0; f < 4; f++) {
+            perBand([&](int b, int r0, int r1) {
+                fresh[b] = deleted[b].size();
+                auto test{[&](int i, int j) {
+                    uchar *p{image_.ptr<uchar>(i) + j};
+                    if (mark.ptr<uchar>(i)[j] && *p && shrink[Neighborhood::code(image_, i, j)] == 0) {
+                        *p = 0;
+                        deleted[b].push_back(i * n + j);
+                    }
+                }};
+
+                if (dense) {
+                    for (int i = r0 + ((r0 & 1) != (f >> 1)); i < r1; i += 2)
+                        for (int j = f & 1; j < n; j += 2) test(i, j);
+                    return;
+                }
+                std::vector<int> &list{work[static_cast<std::size_t>(f) * bands + b]};
+                for (int k : list) {
+                    listed[k] = 0;
+                    test(k / n, k % n);
+                }
+                list.clear();
+            });
+            if (dense || f == 3) continue;
+
+            // the later subfields of this sweep see these deletions
+            perBand([&](int b, int r0, int r1) {
+                around(b, r0, r1, [&](int c) { return fresh[c]; }, [&](int y, int x) {
+                    if (field(y, x) > f) enlist(b, y, x);
+                });
+            });
+        }
+
+        std::size_t count{0};
+        for (auto &d : deleted) count += d.size();
+        if (count == 0) break;
+
+        dense = count * Sparse > N;
+        if (dense) {
+            label = Neighborhood::apply(image_, yokoi, bands);
+            mark = Thinning::marks(label, bands);
+            continue;
+        }
+
+        // relabel this band's pixels within one pixel of a deletion
+        perBand([&](int b, int r0, int r1) {
+            changed[b].clear();
+            around(b, r0, r1, [](int) { return std::size_t{0}; }, [&](int y, int x) {
+                int q{y * n + x};
+                if (relabelled[q]) return;
+                relabelled[q] = 1;
+                label.ptr<uchar>(y)[x] = yokoi[Neighborhood::code(image_, y, x)];
+                changed[b].push_back(q);
+            });
+        });
+
+        // remark this band's pixels next to a new label and queue them
+        perBand([&](int b, int r0, int r1) {
+            const int dirs[5][2]{{0, 0}, {-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+            remarks[b].clear();
+            for (int c = std::max(0, b - 1); c <= std::min(bands - 1, b + 1); c++) {
+                for (int k : changed[c]) {
+                    int i{k / n}, j{k % n};
+                    for (auto &d : dirs) {
+                        int y{i + d[0]}, x{j + d[1]};
+                        if (y < r0 || x < 0 || y >= r1 || x >= n || remarked[y * n + x]) continue;
+                        remarked[y * n + x] = 1;
+                        remarks[b].push_back(y * n + x);
+                        mark.ptr<uchar>(y)[x] = markAt(y, x);
+                        enlist(b, y, x);
+                    }
+                }
+            }
+            for (int q : remarks[b]) remarked[q] = 0;
+            for (int q : changed[b]) relabelled[q] = 0;
+        });
+    }
+
+    return image_;
+}
+
+// Skeleton anchored on the medial axis. One distance transform gives every
+// foreground pixel the squared distance d2 to the background (outside the
+// image counting as background). A pixel is on the axis when no 8-neighbour
+// q has d(q) >= d(p) + |q - p| / 2 (half a step absorbs the rounding of
+// digital disks), and of the two equally distant centres of an even-width
+// stroke only the later one in raster order is. A single pass then visits
+// the foreground from the background inwards (ascending d2, raster order
+// among equals) and deletes every pixel off the axis that the shrink rule
+// allows; a deletion re-tries the neighbours already visited, which may
+// have been kept only because this pixel was still there. The shrink rule
+// is evaluated on the current image, so connectivity is preserved as in the
+// iterative thinning, each pixel is re-tried at most eight times, and the
+// cost is linear in the pixel count for any stroke width. A last pass thins
+// the 2x2 blocks that adjacent axis pixels can leave.
+inline cv::Mat medialAxisThinning(const cv::Mat &image, const Neighborhood::Table &shrink) {
+    int m = image.rows, n = image.cols;
+    cv::Mat image_{image.clone()};
+    if (m == 0 || n == 0) return image_;
+
+    cv::Mat padded(m + 2, n + 2, CV_8UC1, cv::Scalar::all(0));
+    for (int i = 0; i < m; i++) {
+        const uchar *src{image.ptr<uchar>(i)};
+        std::copy(src, src + n, padded.ptr<uchar>(i + 1) + 1);
+    }
+    cv::Mat D{squaredDistanceToBackground(padded)};
+
+    std::size_t N{static_cast<std::size_t>(m) * n};
+    std::vector<int> d2(N, 0), foreground;
+    for (int i = 0; i < m; i++) {
+        const uchar *src{image.ptr<uchar>(i)};
+        const int *d{D.ptr<int>(i + 1) + 1};
+        for (int j = 0; j < n; j++) {
+            if (!src[j]) continue;
+            d2[i * n + j] = d[j];
+            foreground.push_back(i * n + j);
+        }
+    }
+
+    // 0 for background and pixels outside the image
+    auto at{[&](int y, int x) { return y < 0 || x < 0 || y >= m || x >= n ? 0 : d2[y * n + x]; }};
+    std::vector<uchar> axis(N, 0);
+    for (int k : foreground) {
+        int i{k / n}, j{k % n};
+        double r{std::sqrt(static_cast<double>(d2[k]))};
+        bool maximal = true;
+        for (int dy = -1; dy <= 1 && maximal; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                if (dy == 0 && dx == 0) continue;
+                int q{at(i + dy, j + dx)};
+                // the later of two equally distant centres of an even-width stroke
+                bool twin{dy * dx == 0 && (dy > 0 || dx > 0) && q == d2[k] && at(i - dy, j - dx) < d2[k]};
+                if (twin || std::sqrt(static_cast<double>(q)) >= r + 0.5 * std::sqrt(static_cast<double>(dy * dy + dx * dx))) {
+                    maximal = false;
+                    break;
+                }
+            }
+        }
+        axis[k] = maximal;
+    }
+
+    // a pixel kept at its turn can become removable when a neighbour goes
+    // later; visited neighbours of each deletion are tried again at once
+    std::vector<uchar> visited(N, 0);
+    std::vector<int> retry;
+    auto remove{[&](int k) {
+        int i{k / n}, j{k % n};
+        int code{Neighborhood::code(image_, i, j)};
+        if (axis[k] || shrink[code] != 0) return false;
+        image_.ptr<uchar>(i)[j] = 0;
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                if ((dy == 0 && dx == 0) || !Neighborhood::at(code, dy, dx)) continue;
+                int q{(i + dy) * n + j + dx};
+                if (visited[q]) retry.push_back(q);
+            }
+        }
+        return true;
+    }};
+
+    for (int k : Thinning::byDistance(d2, foreground)) {
+        visited[k] = 1;
+        if (!remove(k)) continue;
+        while (!retry.empty()) {
+            int q{retry.back()};
+            retry.pop_back();
+            if (image_.ptr<uchar>(q / n)[q % n]) remove(q);
+        }
+    }
+
+    // adjacent axis pixels can still form 2x2 blocks; delete the block pixels
+    // the shrink rule allows, axis or not, so a block is only left where each
+    // of its pixels joins parts that would otherwise separate
+    auto on{[&](int y, int x) { return y >= 0 && x >= 0 && y < m && x < n && image_.ptr<uchar>(y)[x]; }};
+    auto inBlock{[&](int i, int j) {
+        for (int y = i - 1; y <= i; y++)
+            for (int x = j - 1; x <= j; x++)
+                if (on(y, x) && on(y + 1, x) && on(y, x + 1) && on(y + 1, x + 1)) return true;
+        return false;
+    }};
+    for (auto k{foreground.rbegin()}; k != foreground.rend(); ++k) {
+        if (on(*k / n, *k % n) && inBlock(*k / n, *k % n)) retry.push_back(*k);
+    }
+    while (!retry.empty()) {
+        int k{retry.back()}, i{k / n}, j{k % n};
+        retry.pop_back();
+        if (!on(i, j) || !inBlock(i, j)) continue;
+        int code{Neighborhood::code(image_, i, j)};
+        if (shrink[code] != 0) continue;
+        image_.ptr<uchar>(i)[j] = 0;
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                if ((dy != 0 || dx != 0) && Neighborhood::at(code, dy, dx)) retry.push_back((i + dy) * n + j + dx);
+            }
+        }
+    }
+
+    return image_;
+}
+
+#endif
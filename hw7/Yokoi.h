@@ -0,0 +1,48 @@
+#ifndef YOKOI_H
+#define YOKOI_H
+
+#include <vector>
+
+#include "../Neighborhood.h"
+
+// Yokoi connectivity number and connected shrink operator as window tables,
+// shared by hw7 and its benchmark.
+inline char h_yokoi(int b, int c, int d, int e) {
+    if (b != c) return 's';
+    if (b == d && b == e) return 'r';
+    return 'q';
+}
+
+inline int f_yokoi(const std::vector<char> &a) {
+    int q_count = 0, r_count = 0;
+    for (char c : a) {
+        r_count += (c == 'r') ? 1 : 0;
+        q_count += (c == 'q') ? 1 : 0;
+    }
+    return (r_count == 4) ? 5 : q_count;
+}
+
+inline char h_shrink(int b, int c, int d, int e) {
+    if (b == c && (b != d || b != e)) return '1';
+    return '0';
+}
+
+inline int f_shrink(const std::vector<char> &a, int x) {
+    int a_count = 0;
+    for (char c : a) {
+        a_count += (c == '1') ? 1 : 0;
+    }
+    return (a_count == 1) ? 0 : x;
+}
+
+// Yokoi number of the centre pixel, 0 for background
+const Neighborhood::Table yokoiTable{Neighborhood::compile([](int code) {
+    return Neighborhood::x(code, 0) ? f_yokoi(Neighborhood::quadrants(code, h_yokoi)) : 0;
+})};
+
+// 0 where the centre pixel may be removed without disconnecting its neighbours
+const Neighborhood::Table shrinkTable{Neighborhood::compile([](int code) {
+    return f_shrink(Neighborhood::quadrants(code, h_shrink), 1);
+})};
+
+#endif
@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <iostream>
+#include <opencv2/core.hpp>
+#include <random>
+#include <vector>
+
+#include "../utils.cpp"
+#include "Thinning.h"
+#include "Yokoi.h"
+
+// Random thick strokes (axis-aligned bars and rings) of the given width, the
+// case where the iterative thinning needs about width / 2 sweeps.
+cv::Mat strokes(int size, int width, unsigned seed) {
+    std::mt19937 rng{seed};
+    std::uniform_int_distribution<int> pos(0, size - 1), len(size / 8, size / 2);
+    cv::Mat image(size, size, CV_8UC1, cv::Scalar::all(0));
+
+    for (int s = 0; s < 24; s++) {
+        int y{pos(rng)}, x{pos(rng)}, l{len(rng)};
+        if (s % 3 == 2) {
+            int r0{l / 4}, r1{l / 4 + width};
+            for (int i = std::max(0, y - r1); i <= std::min(size - 1, y + r1); i++) {
+                uchar *dst{image.ptr<uchar>(i)};
+                for (int j = std::max(0, x - r1); j <= std::min(size - 1, x + r1); j++) {
+                    int d2{(i - y) * (i - y) + (j - x) * (j - x)};
+                    if (d2 >= r0 * r0 && d2 <= r1 * r1) dst[j] = 0xFF;
+                }
+            }
+            continue;
+        }
+        bool horizontal{s % 3 == 0};
+        int h{horizontal ? width : l}, w{horizontal ? l : width};
+        for (int i = y; i < std::min(size, y + h); i++) {
+            uchar *dst{image.ptr<uchar>(i)};
+            std::fill(dst + x, dst + std::min(size, x + w), 0xFF);
+        }
+    }
+
+    return image;
+}
+
+long long count(const cv::Mat &image) {
+    long long c = 0;
+    for (int i = 0; i < image.rows; i++) {
+        const uchar *src{image.ptr<uchar>(i)};
+        for (int j = 0; j < image.cols; j++) c += src[j] != 0;
+    }
+    return c;
+}
+
+int main() {
+    constexpr int size{1024};
+
+    for (int width : {4, 16, 64}) {
+        cv::Mat image{strokes(size, width, 11533u + width)};
+
+        Timer t;
+        cv::Mat a{incrementalThinning(image, yokoiTable, shrinkTable)};
+        double tThinning{t.elapsed()};
+
+        t.reset();
+        cv::Mat b{subfieldThinning(image, yokoiTable, shrinkTable, cv::getNumThreads())};
+        double tSubfield{t.elapsed()};
+
+        t.reset();
+        cv::Mat c{medialAxisThinning(image, shrinkTable)};
+        double tMedial{t.elapsed()};
+
+        std::cout << "width " << width << ": thinning " << tThinning << "s (" << count(a) << " px), subfield "
+                  << tSubfield << "s (" << count(b) << " px), medial axis " << tMedial << "s (" << count(c) << " px)"
+                  << std::endl;
+    }
+
+    return 0;
+}
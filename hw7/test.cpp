@@ -0,0 +1,258 @@
+#include <iostream>
+#include <opencv2/core.hpp>
+#include <random>
+#include <vector>
+
+#include "Thinning.h"
+#include "Yokoi.h"
+
+// Checks incrementalThinning against the full-image Yokoi / pair relation /
+// connected shrink loop it replaced. Checks subfieldThinning: the same skeleton for any thread and band count,
+// the same as recomputing every label and mark before each sweep, and
+// the same number of 4-connected components as the input. Checks that
+// medialAxisThinning keeps the components and holes of its input, stays
+// inside it, leaves no 2x2 block it could thin, and reduces even-width bars
+// to one line.
+
+// smoothed random noise, thresholded into blobs of varying thickness
+cv::Mat blobs(int m, int n, std::mt19937 &rng) {
+    std::uniform_int_distribution<int> value(0, 255);
+    std::vector<int> noise(static_cast<std::size_t>(m) * n);
+    for (int &v : noise) v = value(rng);
+
+    cv::Mat image(m, n, CV_8UC1);
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < n; j++) {
+            int sum = 0, count = 0;
+            for (int y = std::max(0, i - 3); y <= std::min(m - 1, i + 3); y++)
+                for (int x = std::max(0, j - 3); x <= std::min(n - 1, j + 3); x++) sum += noise[y * n + x], count++;
+            image.at<uchar>(i, j) = sum > 128 * count ? 255 : 0;
+        }
+    }
+    return image;
+}
+
+// subfieldThinning without the frontier: every sweep relabels and remarks
+// the whole image and tests every pixel of each subfield
+cv::Mat reference(const cv::Mat &image) {
+    int m = image.rows, n = image.cols;
+    cv::Mat image_{image.clone()};
+    for (bool change = true; change;) {
+        change = false;
+        cv::Mat mark{Thinning::marks(Neighborhood::apply(image_, yokoiTable), 1)};
+        for (int field = 0; field < 4; field++) {
+            for (int i = field >> 1; i < m; i += 2) {
+                for (int j = field & 1; j < n; j += 2) {
+                    if (mark.at<uchar>(i, j) && image_.at<uchar>(i, j) && shrinkTable[Neighborhood::code(image_, i, j)] == 0) {
+                        image_.at<uchar>(i, j) = 0;
+                        change = true;
+                    }
+                }
+            }
+        }
+    }
+    return image_;
+}
+
+// the original hw7 loop: every iteration labels the whole image, marks the
+// pair relation and shrinks in raster order, deletions visible to the
+// pixels after them
+cv::Mat raster(const cv::Mat &image) {
+    int m = image.rows, n = image.cols;
+    cv::Mat image_{image.clone()};
+    for (bool change = true; change;) {
+        change = false;
+        std::vector<std::vector<int>> label(m, std::vector<int>(n, 0));
+        for (int i = 0; i < m; i++) {
+            Neighborhood::Window w(image_, i);
+            for (int j = 0; j < n; j++) label[i][j] = yokoiTable[w.next()];
+        }
+
+        const int dirs[4][2]{{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+        std::vector<std::vector<char>> marked(m, std::vector<char>(n, ' '));
+        for (int i = 0; i < m; i++) {
+            for (int j = 0; j < n; j++) {
+                if (label[i][j] == 0) continue;
+                int one_count = 0;
+                for (auto &d : dirs) {
+                    int y{i + d[0]}, x{j + d[1]};
+                    if (y >= 0 && x >= 0 && y < m && x < n) one_count += label[y][x] == 1;
+                }
+                marked[i][j] = one_count >= 1 && label[i][j] == 1 ? 'p' : 'q';
+            }
+        }
+
+        for (int i = 0; i < m; i++) {
+            uchar *src{image_.ptr<uchar>(i)};
+            Neighborhood::Window w(image_, i);
+            for (int j = 0; j < n; j++) {
+                int code{w.next()};
+                if (marked[i][j] == 'p' && shrinkTable[code] == 0) {
+                    src[j] = 0;
+                    w.update(0, 0, false);
+                    change = true;
+                }
+            }
+        }
+    }
+    return image_;
+}
+
+// 4-connected components of the pixels equal to value (8-connected with
+// eight), foreground by default
+int components(const cv::Mat &image, uchar value = 255, bool eight = false) {
+    int m = image.rows, n = image.cols, count = 0;
+    std::vector<char> seen(static_cast<std::size_t>(m) * n, 0);
+    std::vector<int> stack;
+    for (int k = 0; k < m * n; k++) {
+        if (seen[k] || image.at<uchar>(k / n, k % n) != value) continue;
+        count++;
+        seen[k] = 1;
+        stack.push_back(k);
+        while (!stack.empty()) {
+            int i{stack.back() / n}, j{stack.back() % n};
+            stack.pop_back();
+            const int dirs[8][2]{{-1, 0}, {1, 0}, {0, -1}, {0, 1}, {-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
+            for (int d = 0; d < (eight ? 8 : 4); d++) {
+                int y{i + dirs[d][0]}, x{j + dirs[d][1]};
+                if (y < 0 || x < 0 || y >= m || x >= n || seen[y * n + x] || image.at<uchar>(y, x) != value) continue;
+                seen[y * n + x] = 1;
+                stack.push_back(y * n + x);
+            }
+        }
+    }
+    return count;
+}
+
+// background components (8-connected, dual to 4-connected foreground)
+// that do not reach the image border
+int holes(const cv::Mat &image) {
+    cv::Mat padded(image.rows + 2, image.cols + 2, CV_8UC1, cv::Scalar::all(0));
+    for (int i = 0; i < image.rows; i++)
+        for (int j = 0; j < image.cols; j++) padded.at<uchar>(i + 1, j + 1) = image.at<uchar>(i, j) ? 255 : 0;
+    return components(padded, 0, true) - 1;
+}
+
+bool subset(const cv::Mat &a, const cv::Mat &b) {
+    for (int i = 0; i < a.rows; i++)
+        for (int j = 0; j < a.cols; j++)
+            if (a.at<uchar>(i, j) && !b.at<uchar>(i, j)) return false;
+    return true;
+}
+
+int blocks(const cv::Mat &image) {
+    int count = 0;
+    for (int i = 0; i + 1 < image.rows; i++)
+        for (int j = 0; j + 1 < image.cols; j++)
+            count += image.at<uchar>(i, j) && image.at<uchar>(i + 1, j) && image.at<uchar>(i, j + 1) && image.at<uchar>(i + 1, j + 1);
+    return count;
+}
+
+// no 2x2 block with a pixel the shrink rule would remove; a block whose
+// pixels each join parts that would otherwise separate must stay
+bool thin(const cv::Mat &image) {
+    for (int i = 0; i + 1 < image.rows; i++) {
+        for (int j = 0; j + 1 < image.cols; j++) {
+            if (!image.at<uchar>(i, j) || !image.at<uchar>(i + 1, j) || !image.at<uchar>(i, j + 1) || !image.at<uchar>(i + 1, j + 1))
+                continue;
+            for (int y = i; y <= i + 1; y++)
+                for (int x = j; x <= j + 1; x++)
+                    if (shrinkTable[Neighborhood::code(image, y, x)] == 0) return false;
+        }
+    }
+    return true;
+}
+
+int medialAxis(const cv::Mat &image) {
+    cv::Mat skeleton{medialAxisThinning(image, shrinkTable)};
+    int failures = 0;
+    auto expect{[&](bool ok, const char *what) {
+        if (ok) return;
+        std::cout << "[FAIL] medial axis " << what << ' ' << image.size() << '\n';
+        failures++;
+    }};
+    expect(components(skeleton) == components(image), "components");
+    expect(holes(skeleton) == holes(image), "holes");
+    expect(subset(skeleton, image), "subset");
+    expect(thin(skeleton), "2x2 block");
+    return failures;
+}
+
+// a width x length bar, horizontal or not, thins to one full-length line
+int bar(int width, int length, bool horizontal) {
+    int m{horizontal ? width + 6 : length + 6}, n{horizontal ? length + 6 : width + 6};
+    cv::Mat image(m, n, CV_8UC1, cv::Scalar::all(0));
+    for (int i = 3; i < m - 3; i++)
+        for (int j = 3; j < n - 3; j++) image.at<uchar>(i, j) = 255;
+
+    cv::Mat skeleton{medialAxisThinning(image, shrinkTable)};
+    // every pixel on one row (or column) across the bar
+    int line{-1}, count = 0;
+    bool ok = true;
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < n; j++) {
+            if (!skeleton.at<uchar>(i, j)) continue;
+            int across{horizontal ? i : j};
+            ok = ok && (line < 0 || line == across);
+            line = across;
+            count++;
+        }
+    }
+    if (ok && count > 0 && count <= length) return 0;
+    std::cout << "[FAIL] medial axis bar " << width << 'x' << length << (horizontal ? " horizontal" : " vertical") << '\n';
+    return 1;
+}
+
+bool same(const cv::Mat &a, const cv::Mat &b) {
+    for (int i = 0; i < a.rows; i++)
+        for (int j = 0; j < a.cols; j++)
+            if (a.at<uchar>(i, j) != b.at<uchar>(i, j)) return false;
+    return true;
+}
+
+int main() {
+    std::mt19937 rng(7);
+    const int sizes[][2]{{1, 9}, {2, 2}, {3, 17}, {17, 3}, {40, 40}, {64, 97}, {131, 80}};
+    const int threads[]{1, 2, 3, 8}, bands[]{1, 2, 3, 7, 16, 200};
+
+    int failures = 0;
+    for (auto &s : sizes) {
+        cv::Mat image{blobs(s[0], s[1], rng)};
+        cv::Mat expected{reference(image)};
+        if (components(expected) != components(image)) {
+            std::cout << "[FAIL] connectivity " << image.size() << '\n';
+            failures++;
+        }
+        failures += medialAxis(image);
+        if (!same(incrementalThinning(image, yokoiTable, shrinkTable), raster(image))) {
+            std::cout << "[FAIL] incremental " << image.size() << '\n';
+            failures++;
+        }
+
+        for (int t : threads) {
+            cv::setNumThreads(t);
+            for (int b : bands) {
+                if (!same(subfieldThinning(image, yokoiTable, shrinkTable, b), expected)) {
+                    std::cout << "[FAIL] " << image.size() << " threads " << t << " bands " << b << '\n';
+                    failures++;
+                }
+            }
+        }
+    }
+
+    // a lone 2x2 square thins to one pixel, leaving no block
+    cv::Mat square(6, 6, CV_8UC1, cv::Scalar::all(0));
+    for (int i = 2; i <= 3; i++)
+        for (int j = 2; j <= 3; j++) square.at<uchar>(i, j) = 255;
+    failures += medialAxis(square);
+    if (blocks(medialAxisThinning(square, shrinkTable)) != 0) {
+        std::cout << "[FAIL] medial axis square\n";
+        failures++;
+    }
+
+    for (int width : {2, 4, 6, 10})
+        for (bool horizontal : {true, false}) failures += bar(width, 31, horizontal);
+
+    std::cout << (failures ? "FAILED" : "passed") << '\n';
+    return failures ? 1 : 0;
+}
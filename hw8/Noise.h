@@ -0,0 +1,227 @@
+#ifndef NOISE_H
+#define NOISE_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <opencv2/core.hpp>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Counter-based noise (Philox4x32-10, Salmon et al.). Block b of a stream is
+// philox({b, b >> 32, stream, 0}, seed): four 32-bit words that depend only
+// on the seed, the stream and b, with no state carried between calls. Pixel
+// k = i * cols + j of an image uses word k % 4 of block k / 4, so any row,
+// tile or thread can generate its pixels on its own and the image is the
+// same for any split. The blocks of a row are generated 4 (SSE2) or 8 (AVX2)
+// at a time, one counter per SIMD lane.
+namespace Noise {
+    using Block = std::array<std::uint32_t, 4>;
+
+    enum Stream : std::uint32_t { Gaussian,
+                                  SaltAndPepper };
+
+    constexpr std::uint32_t M0{0xD2511F53}, M1{0xCD9E8D57}, W0{0x9E3779B9}, W1{0xBB67AE85};
+    constexpr int Rounds{10};
+
+    inline Block philox(Block c, std::uint64_t seed) {
+        std::uint32_t k0{static_cast<std::uint32_t>(seed)}, k1{static_cast<std::uint32_t>(seed >> 32)};
+        for (int r = 0; r < Rounds; r++) {
+            std::uint64_t p0{std::uint64_t{M0} * c[0]}, p1{std::uint64_t{M1} * c[2]};
+            c = {static_cast<std::uint32_t>(p1 >> 32) ^ c[1] ^ k0, static_cast<std::uint32_t>(p1),
+                 static_cast<std::uint32_t>(p0 >> 32) ^ c[3] ^ k1, static_cast<std::uint32_t>(p0)};
+            k0 += W0;
+            k1 += W1;
+        }
+        return c;
+    }
+
+#if defined(__AVX2__)
+    // 32x32 -> 64-bit products of every lane, split into high and low words
+    inline void mulhilo(__m256i a, std::uint32_t m, __m256i &hi, __m256i &lo) {
+        __m256i M{_mm256_set1_epi32(static_cast<int>(m))};
+        __m256i p02{_mm256_mul_epu32(a, M)}, p13{_mm256_mul_epu32(_mm256_srli_epi64(a, 32), M)};
+        lo = _mm256_blend_epi32(p02, _mm256_slli_epi64(p13, 32), 0xAA);
+        hi = _mm256_blend_epi32(_mm256_srli_epi64(p02, 32), p13, 0xAA);
+    }
+#elif defined(__SSE2__)
+    inline void mulhilo(__m128i a, std::uint32_t m, __m128i &hi, __m128i &lo) {
+        const __m128i even{_mm_set_epi32(0, -1, 0, -1)}, odd{_mm_set_epi32(-1, 0, -1, 0)};
+        __m128i M{_mm_set1_epi32(static_cast<int>(m))};
+        __m128i p02{_mm_mul_epu32(a, M)}, p13{_mm_mul_epu32(_mm_srli_epi64(a, 32), M)};
+        lo = _mm_or_si128(_mm_and_si128(p02, even), _mm_slli_epi64(p13, 32));
+        hi = _mm_or_si128(_mm_srli_epi64(p02, 32), _mm_and_si128(p13, odd));
+    }
+#endif
+
+    // out[4 * b + w] = word w of block first + b, for b < count
+    inline void blocks(std::uint64_t first, int count, Stream stream, std::uint64_t seed, std::uint32_t *out) {
+        int b = 0;
+        std::uint32_t k0{static_cast<std::uint32_t>(seed)}, k1{static_cast<std::uint32_t>(seed >> 32)};
+#if defined(__AVX2__)
+        for (; b + 8 <= count; b += 8) {
+            std::uint64_t c{first + b};
+            __m256i c0{_mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(c)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7))};
+            // the high word carries when the low word wraps inside the group
+            __m256i c1{_mm256_sub_epi32(_mm256_set1_epi32(static_cast<int>(c >> 32)),
+                                        _mm256_cmpgt_epi32(_mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(c)), _mm256_set1_epi32(INT32_MIN)),
+                                                           _mm256_xor_si256(c0, _mm256_set1_epi32(INT32_MIN))))};
+            __m256i c2{_mm256_set1_epi32(static_cast<int>(stream))}, c3{_mm256_setzero_si256()};
+            __m256i K0{_mm256_set1_epi32(static_cast<int>(k0))}, K1{_mm256_set1_epi32(static_cast<int>(k1))};
+            for (int r = 0; r < Rounds; r++) {
+                __m256i hi0, lo0, hi1, lo1;
+                mulhilo(c0, M0, hi0, lo0);
+                mulhilo(c2, M1, hi1, lo1);
+                c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), K0);
+                c1 = lo1;
+                c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), K1);
+                c3 = lo0;
+                K0 = _mm256_add_epi32(K0, _mm256_set1_epi32(static_cast<int>(W0)));
+                K1 = _mm256_add_epi32(K1, _mm256_set1_epi32(static_cast<int>(W1)));
+            }
+            // lanes hold blocks, rows of the 4x8 word matrix become blocks
+            __m256i t0{_mm256_unpacklo_epi32(c0, c1)}, t1{_mm256_unpacklo_epi32(c2, c3)};
+            __m256i t2{_mm256_unpackhi_epi32(c0, c1)}, t3{_mm256_unpackhi_epi32(c2, c3)};
+            __m256i r0{_mm256_unpacklo_epi64(t0, t1)}, r1{_mm256_unpackhi_epi64(t0, t1)};
+            __m256i r2{_mm256_unpacklo_epi64(t2, t3)}, r3{_mm256_unpackhi_epi64(t2, t3)};
+            __m256i *dst{reinterpret_cast<__m256i *>(out + 4 * b)};
+            _mm256_storeu_si256(dst, _mm256_permute2x128_si256(r0, r1, 0x20));
+            _mm256_storeu_si256(dst + 1, _mm256_permute2x128_si256(r2, r3, 0x20));
+            _mm256_storeu_si256(dst + 2, _mm256_permute2x128_si256(r0, r1, 0x31));
+            _mm256_storeu_si256(dst + 3, _mm256_permute2x128_si256(r2, r3, 0x31));
+        }
+#elif defined(__SSE2__)
+        for (; b + 4 <= count; b += 4) {
+            std::uint64_t c{first + b};
+            __m128i c0{_mm_add_epi32(_mm_set1_epi32(static_cast<int>(c)), _mm_setr_epi32(0, 1, 2, 3))};
+            // the high word carries when the low word wraps inside the group
+            __m128i c1{_mm_sub_epi32(_mm_set1_epi32(static_cast<int>(c >> 32)),
+                                     _mm_cmpgt_epi32(_mm_xor_si128(_mm_set1_epi32(static_cast<int>(c)), _mm_set1_epi32(INT32_MIN)),
+                                                     _mm_xor_si128(c0, _mm_set1_epi32(INT32_MIN))))};
+            __m128i c2{_mm_set1_epi32(static_cast<int>(stream))}, c3{_mm_setzero_si128()};
+            __m128i K0{_mm_set1_epi32(static_cast<int>(k0))}, K1{_mm_set1_epi32(static_cast<int>(k1))};
+            for (int r = 0; r < Rounds; r++) {
+                __m128i hi0, lo0, hi1, lo1;
+                mulhilo(c0, M0, hi0, lo0);
+                mulhilo(c2, M1, hi1, lo1);
+                c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), K0);
+                c1 = lo1;
+                c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), K1);
+                c3 = lo0;
+                K0 = _mm_add_epi32(K0, _mm_set1_epi32(static_cast<int>(W0)));
+                K1 = _mm_add_epi32(K1, _mm_set1_epi32(static_cast<int>(W1)));
+            }
+            __m128i t0{_mm_unpacklo_epi32(c0, c1)}, t1{_mm_unpacklo_epi32(c2, c3)};
+            __m128i t2{_mm_unpackhi_epi32(c0, c1)}, t3{_mm_unpackhi_epi32(c2, c3)};
+            __m128i *dst{reinterpret_cast<__m128i *>(out + 4 * b)};
+            _mm_storeu_si128(dst, _mm_unpacklo_epi64(t0, t1));
+            _mm_storeu_si128(dst + 1, _mm_unpackhi_epi64(t0, t1));
+            _mm_storeu_si128(dst + 2, _mm_unpacklo_epi64(t2, t3));
+            _mm_storeu_si128(dst + 3, _mm_unpackhi_epi64(t2, t3));
+        }
+#endif
+        for (; b < count; b++) {
+            std::uint64_t c{first + b};
+            Block w{philox({static_cast<std::uint32_t>(c), static_cast<std::uint32_t>(c >> 32), stream, 0}, seed)};
+            std::copy(w.begin(), w.end(), out + 4 * b);
+        }
+    }
+
+    // Words of pixels k0 .. k0 + len - 1; buffer is scratch of any size.
+    inline const std::uint32_t *words(std::uint64_t k0, int len, Stream stream, std::uint64_t seed, std::vector<std::uint32_t> &buffer) {
+        std::uint64_t first{k0 / 4}, last{(k0 + len + 3) / 4};
+        buffer.resize(4 * (last - first));
+        blocks(first, static_cast<int>(last - first), stream, seed, buffer.data());
+        return buffer.data() + (k0 - 4 * first);
+    }
+
+    // in [0, 1) and (0, 1]
+    inline double uniform(std::uint32_t w) {
+        return w * (1.0 / 4294967296.0);
+    }
+
+    inline double positive(std::uint32_t w) {
+        return (w + 1.0) * (1.0 / 4294967296.0);
+    }
+
+    // Box-Muller over whole blocks: words (2a, 2a + 1) give the normals of
+    // pixels 2a and 2a + 1, so pairs never straddle two blocks.
+    inline void normals(const std::uint32_t *w, int len, double *z) {
+        constexpr double Tau{6.283185307179586};
+        for (int k = 0; k < len; k += 2) {
+            double r{std::sqrt(-2.0 * std::log(positive(w[k])))}, theta{Tau * uniform(w[k + 1])};
+            z[k] = r * std::cos(theta);
+            z[k + 1] = r * std::sin(theta);
+        }
+    }
+
+    // Calls f(i, z) for every row i with the normals of its pixels, in parallel
+    // row ranges.
+    template <class F>
+    void gaussianRows(int m, int n, std::uint64_t seed, F f) {
+        cv::parallel_for_(cv::Range(0, m), [&](const cv::Range &range) {
+            std::vector<std::uint32_t> buffer;
+            std::vector<double> z(n + 4);
+            for (int i = range.start; i < range.end; i++) {
+                // start at an even pixel so the Box-Muller pairs line up
+                std::uint64_t k0{std::uint64_t(i) * n}, even{k0 & ~std::uint64_t{1}};
+                int len{static_cast<int>(k0 + n - even + 1) & ~1};
+                normals(words(even, len, Gaussian, seed, buffer), len, z.data());
+                f(i, z.data() + (k0 - even));
+            }
+        });
+    }
+
+    // image + amplitude * N(0, 1) truncated to an integer, clamped to [0, 255]
+    inline cv::Mat addGaussian(const cv::Mat &image, int amplitude, std::uint64_t seed) {
+        int m = image.rows, n = image.cols;
+        cv::Mat image_(m, n, CV_8UC1, cv::Scalar::all(0));
+
+        gaussianRows(m, n, seed, [&](int i, const double *z) {
+            const uchar *src{image.ptr<uchar>(i)};
+            uchar *dst{image_.ptr<uchar>(i)};
+            for (int j = 0; j < n; j++) {
+                int noisePixel{src[j] + amplitude * static_cast<int>(z[j])};
+                if (noisePixel < 0) noisePixel = 0;
+                if (noisePixel > 255) noisePixel = 255;
+                dst[j] = noisePixel;
+            }
+        });
+
+        return image_;
+    }
+
+    // pixels below threshold become 0, above 1 - threshold 255
+    inline cv::Mat addSaltAndPepper(const cv::Mat &image, double threshold, std::uint64_t seed) {
+        int m = image.rows, n = image.cols;
+        cv::Mat image_(m, n, CV_8UC1, cv::Scalar::all(0));
+
+        cv::parallel_for_(cv::Range(0, m), [&](const cv::Range &range) {
+            std::vector<std::uint32_t> buffer;
+            for (int i = range.start; i < range.end; i++) {
+                const uchar *src{image.ptr<uchar>(i)};
+                uchar *dst{image_.ptr<uchar>(i)};
+                const std::uint32_t *w{words(std::uint64_t(i) * n, n, SaltAndPepper, seed, buffer)};
+                for (int j = 0; j < n; j++) {
+                    double sample{uniform(w[j])};
+                    if (sample < threshold)
+                        dst[j] = 0;
+                    else if (sample > 1 - threshold)
+                        dst[j] = 255;
+                    else
+                        dst[j] = src[j];
+                }
+            }
+        });
+
+        return image_;
+    }
+}  // namespace Noise
+
+#endif
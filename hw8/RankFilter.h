@@ -0,0 +1,153 @@
+#ifndef RANKFILTER_H
+#define RANKFILTER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <opencv2/core.hpp>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Constant-time rank filtering (Perreault & Hebert). Every column of the
+// replicate-padded image keeps a fine (256-bin) and a coarse (16-bin)
+// histogram of the kernelSize pixels above and below the current row, so
+// moving down a row costs one add and one remove per column. Along a row only
+// the coarse kernel histogram slides, by adding the entering column and
+// subtracting the leaving one. The fine kernel histogram is kept per coarse
+// bucket and refreshed lazily: when a rank lands in a bucket, only that
+// bucket's 16 fine bins are brought up to the current column, from the
+// columns that entered and left since it was last used (or rebuilt when that
+// was more than a window ago). The cost per pixel does not depend on
+// kernelSize (up to 255, where 16-bit counts would overflow).
+namespace RankFilter {
+    using Count = std::uint16_t;
+    constexpr int Fine{256}, Coarse{16}, Segment{Fine / Coarse};
+
+    // dst += add - sub over len bins (len a multiple of 8)
+    inline void slide(Count *dst, const Count *add, const Count *sub, int len) {
+#if defined(__SSE2__)
+        for (int b = 0; b < len; b += 8) {
+            __m128i d{_mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + b))};
+            __m128i a{_mm_loadu_si128(reinterpret_cast<const __m128i *>(add + b))};
+            __m128i s{_mm_loadu_si128(reinterpret_cast<const __m128i *>(sub + b))};
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + b), _mm_sub_epi16(_mm_add_epi16(d, a), s));
+        }
+#else
+        for (int b = 0; b < len; b++) {
+            dst[b] = dst[b] + add[b] - sub[b];
+        }
+#endif
+    }
+
+    inline void accumulate(Count *dst, const Count *add, int len) {
+#if defined(__SSE2__)
+        for (int b = 0; b < len; b += 8) {
+            __m128i d{_mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + b))};
+            __m128i a{_mm_loadu_si128(reinterpret_cast<const __m128i *>(add + b))};
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + b), _mm_add_epi16(d, a));
+        }
+#else
+        for (int b = 0; b < len; b++) {
+            dst[b] += add[b];
+        }
+#endif
+    }
+
+    // smallest bucket c with more than rank samples in buckets <= c; acc
+    // receives the number of samples below it
+    inline int bucket(const Count *coarse, int rank, int &acc) {
+        int c = 0;
+        acc = 0;
+        while (acc + coarse[c] <= rank) acc += coarse[c++];
+        return c;
+    }
+}  // namespace RankFilter
+
+// kernelSize is odd, in [1, 255]; rank is 0-based over the kernelSize *
+// kernelSize window: 0 is a min filter, kernelSize * kernelSize / 2 the
+// median, the last a max filter.
+inline cv::Mat rankFilter(const cv::Mat &image, int kernelSize, int rank) {
+    using namespace RankFilter;
+    CV_Assert(kernelSize > 0 && kernelSize % 2 == 1 && kernelSize <= 255);
+    CV_Assert(0 <= rank && rank < kernelSize * kernelSize);
+    int m = image.rows, n = image.cols, k = kernelSize / 2;
+    int w{n + 2 * k};
+    cv::Mat image_(m, n, CV_8UC1, cv::Scalar::all(0));
+    if (m == 0 || n == 0) return image_;
+    cv::Mat pad(m + 2 * k, w, CV_8UC1, cv::Scalar::all(0));
+    cv::copyMakeBorder(image, pad, k, k, k, k, cv::BORDER_REPLICATE);
+
+    std::vector<Count> colFine(static_cast<std::size_t>(w) * Fine, 0), colCoarse(static_cast<std::size_t>(w) * Coarse, 0);
+    alignas(16) Count kFine[Fine], kCoarse[Coarse];
+    // column whose window each bucket of kFine reflects, -1 when stale
+    int last[Coarse];
+
+    auto update{[&](int row, int delta) {
+        const uchar *p{pad.ptr<uchar>(row)};
+        for (int c = 0; c < w; c++) {
+            colFine[static_cast<std::size_t>(c) * Fine + p[c]] += delta;
+            colCoarse[static_cast<std::size_t>(c) * Coarse + (p[c] >> 4)] += delta;
+        }
+    }};
+
+    // brings bucket c of kFine to the window of output column j
+    auto refresh{[&](int c, int j) {
+        Count *f{kFine + c * Segment};
+        if (last[c] < 0 || j - last[c] > 2 * k) {
+            std::fill(f, f + Segment, 0);
+            for (int t = j; t <= j + 2 * k; t++) accumulate(f, &colFine[static_cast<std::size_t>(t) * Fine + c * Segment], Segment);
+        } else {
+            for (int t = last[c] + 1; t <= j; t++) {
+                slide(f, &colFine[static_cast<std::size_t>(t + 2 * k) * Fine + c * Segment],
+                      &colFine[static_cast<std::size_t>(t - 1) * Fine + c * Segment], Segment);
+            }
+        }
+        last[c] = j;
+    }};
+
+    auto select{[&](int j) {
+        int acc;
+        int c{bucket(kCoarse, rank, acc)};
+        refresh(c, j);
+        const Count *f{kFine + c * Segment};
+        int v = 0;
+        while (acc + f[v] <= rank) acc += f[v++];
+        return static_cast<uchar>(c * Segment + v);
+    }};
+
+    for (int r = 0; r < 2 * k; r++) update(r, 1);
+
+    for (int i = 0; i < m; i++) {
+        // column histograms now cover padded rows i .. i + 2k
+        if (i > 0) update(i - 1, -1);
+        update(i + 2 * k, 1);
+
+        std::fill(kCoarse, kCoarse + Coarse, 0);
+        std::fill(last, last + Coarse, -1);
+        for (int c = 0; c <= 2 * k; c++) {
+            accumulate(kCoarse, &colCoarse[static_cast<std::size_t>(c) * Coarse], Coarse);
+        }
+
+        uchar *dst{image_.ptr<uchar>(i)};
+        dst[0] = select(0);
+        for (int j = 1; j < n; j++) {
+            std::size_t in{static_cast<std::size_t>(j + 2 * k)}, out{static_cast<std::size_t>(j - 1)};
+            slide(kCoarse, &colCoarse[in * Coarse], &colCoarse[out * Coarse], Coarse);
+            dst[j] = select(j);
+        }
+    }
+
+    return image_;
+}
+
+// percentile in [0, 100]; 50 is the median
+inline cv::Mat percentileFilter(const cv::Mat &image, int kernelSize, double percentile) {
+    CV_Assert(0 <= percentile && percentile <= 100);
+    int N{kernelSize * kernelSize};
+    return rankFilter(image, kernelSize, static_cast<int>(std::lround(percentile / 100 * (N - 1))));
+}
+
+#endif
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <opencv2/core.hpp>
+#include <random>
+#include <vector>
+
+#include "Noise.h"
+
+// Checks Philox4x32-10 against the Random123 known-answer vectors, the SIMD
+// blocks() against scalar philox() for any count and across the carry into
+// the counter's high word, and that the noise images do not depend on the
+// thread count.
+
+int known() {
+    struct Case {
+        Noise::Block counter;
+        std::uint32_t k0, k1;
+        Noise::Block expected;
+    };
+    const Case cases[]{
+        {{0, 0, 0, 0}, 0, 0, {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}},
+        {{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, 0xffffffff, 0xffffffff, {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}},
+        {{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, 0xa4093822, 0x299f31d0, {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}}};
+
+    int failures = 0;
+    for (auto &c : cases) {
+        if (Noise::philox(c.counter, c.k0 | std::uint64_t{c.k1} << 32) != c.expected) {
+            std::cout << "[FAIL] philox known answer " << std::hex << c.counter[0] << std::dec << '\n';
+            failures++;
+        }
+    }
+    return failures;
+}
+
+int blocks() {
+    // the last three start a few blocks before the low counter word wraps
+    const std::uint64_t firsts[]{0, 5, 1000003, 0xfffffffdull, 0xfffffff9ull, 0x1fffffffaull};
+    const int counts[]{1, 3, 4, 5, 7, 8, 9, 13, 16, 17};
+    const std::uint64_t seed{0x0123456789abcdefull};
+
+    int failures = 0;
+    std::vector<std::uint32_t> out;
+    for (std::uint64_t first : firsts) {
+        for (int count : counts) {
+            for (Noise::Stream stream : {Noise::Gaussian, Noise::SaltAndPepper}) {
+                out.assign(4 * count, 0);
+                Noise::blocks(first, count, stream, seed, out.data());
+                for (int b = 0; b < count; b++) {
+                    std::uint64_t c{first + b};
+                    Noise::Block w{Noise::philox({static_cast<std::uint32_t>(c), static_cast<std::uint32_t>(c >> 32), stream, 0}, seed)};
+                    if (!std::equal(w.begin(), w.end(), out.begin() + 4 * b)) {
+                        std::cout << "[FAIL] blocks first " << first << " count " << count << " block " << b << '\n';
+                        failures++;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+bool same(const cv::Mat &a, const cv::Mat &b) {
+    for (int i = 0; i < a.rows; i++)
+        for (int j = 0; j < a.cols; j++)
+            if (a.at<uchar>(i, j) != b.at<uchar>(i, j)) return false;
+    return true;
+}
+
+int threads() {
+    std::mt19937 rng(8);
+    std::uniform_int_distribution<int> value(0, 255);
+
+    int failures = 0;
+    // odd widths, so rows start on odd pixels and mid-block
+    for (auto &s : {std::make_pair(1, 1), {7, 3}, {37, 53}, {64, 129}}) {
+        cv::Mat image(s.first, s.second, CV_8UC1);
+        for (int i = 0; i < image.rows; i++)
+            for (int j = 0; j < image.cols; j++) image.at<uchar>(i, j) = static_cast<uchar>(value(rng));
+
+        cv::setNumThreads(1);
+        cv::Mat g{Noise::addGaussian(image, 30, 11533)}, p{Noise::addSaltAndPepper(image, 0.1, 11533)};
+        for (int t : {2, 3, 8}) {
+            cv::setNumThreads(t);
+            if (!same(Noise::addGaussian(image, 30, 11533), g)) {
+                std::cout << "[FAIL] gaussian " << image.size() << " threads " << t << '\n';
+                failures++;
+            }
+            if (!same(Noise::addSaltAndPepper(image, 0.1, 11533), p)) {
+                std::cout << "[FAIL] salt and pepper " << image.size() << " threads " << t << '\n';
+                failures++;
+            }
+        }
+    }
+    return failures;
+}
+
+int main() {
+    int failures{known() + blocks() + threads()};
+    std::cout << (failures ? "FAILED" : "passed") << '\n';
+    return failures ? 1 : 0;
+}
@@ -1,33 +1,36 @@
 #include <iostream>
 #include <opencv2/imgcodecs.hpp>
 
+#include "../ImageView.h"
 #include "Mask.h"
 
 const cv::String lena{"../lena.bmp"};
 
+// Reads through an ImageView so flipped/rotated inputs need no copy; the
+// replicated border is emulated by clamping coordinates instead of padding.
 template <class T>
-cv::Mat edgeDetect(const cv::Mat &image, const std::vector<Mask<T>> &masks, int threshold, int offset = 0) {
-    int m = image.rows, n = image.cols;
+cv::Mat edgeDetect(const ImageView &image, const std::vector<Mask<T>> &masks, int threshold, int offset = 0) {
+    int m = image.rows(), n = image.cols();
     cv::Mat image_(m, n, CV_8UC1, cv::Scalar::all(0));
-    cv::Mat pad;
-    cv::copyMakeBorder(image, pad, offset, offset, offset, offset, cv::BORDER_REPLICATE);
 
-    for (int i = offset; i < m + offset; i++) {
-        uchar *dst{image_.ptr<uchar>(i - offset)};
-        for (int j = offset; j < n + offset; j++) {
+    for (int i = 0; i < m; i++) {
+        uchar *dst{image_.ptr<uchar>(i)};
+        for (int j = 0; j < n; j++) {
             T acc{}, max{};
             for (const auto &mask : masks) {
                 T conv{};
                 for (int k = 0; k < mask.size(); k++) {
+                    int y{std::min(std::max(i + k - offset, 0), m - 1)};
                     for (int l = 0; l < mask.size(); l++) {
-                        conv += pad.at<uchar>(i + k - offset, j + l - offset) * mask[k][l];
+                        int x{std::min(std::max(j + l - offset, 0), n - 1)};
+                        conv += image(y, x) * mask[k][l];
                     }
                 }
                 acc += conv * conv;
                 max = std::max<T>(max, conv);
             }
             T grad = (masks.size() != 2) ? max : std::sqrt(acc);
-            dst[j - offset] = (grad >= threshold) ? 0 : 255;
+            dst[j] = (grad >= threshold) ? 0 : 255;
         }
     }
 
@@ -1,6 +1,8 @@
 #include <opencv2/core.hpp>
 #include <vector>
 
+#include "CSVWriter.h"
+
 class Timer {
    public:
     Timer() : m_beg{static_cast<double>(cv::getTickCount())} {}
@@ -15,26 +17,4 @@ class Timer {
 
    private:
     double m_beg;
-};
-
-template <class T>
-void writeCSV(const std::vector<std::vector<T>> &v, const cv::String &fileName) {
-    std::ofstream os{fileName, std::ios::out};
-    std::stringstream ss;
-
-    if (!os.is_open()) {
-        std::cerr << "Open file failed..." << std::endl;
-        exit(-1);
-    }
-
-    for (auto &row : v) {
-        for (auto &val : row) {
-            ss << val << ',';
-        }
-        ss << '\n';
-    }
-
-    os << ss.str();
-
-    os.close();
-}
\ No newline at end of file
+};
\ No newline at end of file